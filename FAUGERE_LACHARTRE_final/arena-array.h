@@ -0,0 +1,168 @@
+/*
+ * arena-array.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Aligned array of plain values with the subset of the std::vector interface used by the
+ * multiline rows. Its storage is either its own (grown by doubling, like a vector) or a slice
+ * of an arena shared by all the rows of a bloc, see SparseMultilineBloc::allocateArena.
+ * A slice is never freed by the array; pushing past its end moves the data to storage of its own.
+ * The storage of its own is counted by MemoryAccounting.
+ */
+
+#ifndef ARENA_ARRAY_H_
+#define ARENA_ARRAY_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <algorithm>
+
+#include "consts-macros.h"
+#include "memory-accounting.h"
+
+template <typename T, int Alignment = 16>
+class ArenaArray
+{
+public:
+	typedef T value_type;
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+	ArenaArray () : _ptr (NULL), _size (0), _capacity (0), _owned (true) {}
+
+	ArenaArray (const ArenaArray& other) : _ptr (NULL), _size (0), _capacity (0), _owned (true)
+	{
+		reserve (other._size);
+		if(other._size > 0)
+			memcpy (_ptr, other._ptr, other._size * sizeof (T));
+		_size = other._size;
+	}
+
+	ArenaArray& operator= (const ArenaArray& other)
+	{
+		if(this != &other)
+		{
+			clear ();
+			reserve (other._size);
+			if(other._size > 0)
+				memcpy (_ptr, other._ptr, other._size * sizeof (T));
+			_size = other._size;
+		}
+
+		return *this;
+	}
+
+	~ArenaArray () { release (); }
+
+	/// Empties the array and makes it use the capacity values at ptr, which belong to an arena
+	void bind (T *ptr, uint32 capacity)
+	{
+		release ();
+		_ptr = ptr;
+		_capacity = capacity;
+		_owned = false;
+	}
+
+	/// Frees the storage of the array if it owns it
+	void release ()
+	{
+		if(_owned)
+		{
+			MemoryAccounting::freed (_capacity * sizeof (T));
+			free (_ptr);
+		}
+
+		_ptr = NULL;
+		_size = 0;
+		_capacity = 0;
+		_owned = true;
+	}
+
+	iterator		begin ()		{ return _ptr; }
+	iterator		end ()			{ return _ptr + _size; }
+	const_iterator	begin () const	{ return _ptr; }
+	const_iterator	end () const	{ return _ptr + _size; }
+
+	size_t	size () const		{ return _size; }
+	size_t	capacity () const	{ return _capacity; }
+
+	/// Bytes of the storage of its own, 0 for a slice of an arena
+	size_t	ownedBytes () const	{ return _owned ? _capacity * sizeof (T) : 0; }
+	bool	empty () const		{ return _size == 0; }
+	void	clear ()			{ _size = 0; }
+
+	T&			operator[] (size_t i)		{ return _ptr[i]; }
+	const T&	operator[] (size_t i) const	{ return _ptr[i]; }
+
+	void reserve (size_t sz)
+	{
+		if(sz > _capacity)
+			reallocate (sz);
+	}
+
+	/// Replaces the content by the n values at data
+	void assign (const T *data, size_t n)
+	{
+		_size = 0;
+		reserve (n);
+		if(n > 0)
+			memcpy (_ptr, data, n * sizeof (T));
+		_size = n;
+	}
+
+	inline void push_back (const T& e)
+	{
+		if(_size == _capacity)
+			reallocate (_capacity < 8 ? 8 : 2 * _capacity);
+
+		_ptr[_size++] = e;
+	}
+
+	void swap (ArenaArray& other)
+	{
+		std::swap (_ptr, other._ptr);
+		std::swap (_size, other._size);
+		std::swap (_capacity, other._capacity);
+		std::swap (_owned, other._owned);
+	}
+
+	bool operator== (const ArenaArray& other) const
+	{
+		return _size == other._size && (_size == 0 || memcmp (_ptr, other._ptr, _size * sizeof (T)) == 0);
+	}
+
+private:
+	void reallocate (size_t capacity)
+	{
+		void *p;
+
+		if(posix_memalign (&p, Alignment, capacity * sizeof (T)) != 0)
+			throw std::bad_alloc ();
+
+		MemoryAccounting::allocated (capacity * sizeof (T));
+
+		if(_size > 0)
+			memcpy (p, _ptr, _size * sizeof (T));
+
+		if(_owned)
+		{
+			MemoryAccounting::freed (_capacity * sizeof (T));
+			free (_ptr);
+		}
+
+		_ptr = (T *) p;
+		_capacity = capacity;
+		_owned = true;
+	}
+
+	T *_ptr;
+	uint32 _size;
+	uint32 _capacity;
+	bool _owned;
+};
+
+#endif /* ARENA_ARRAY_H_ */
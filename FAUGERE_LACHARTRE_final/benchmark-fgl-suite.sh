@@ -0,0 +1,64 @@
+#!/bin/sh
+#
+# Sweeps the sizes of matrices generated by generate-f4-matrix and the numbers of threads,
+# runs the sequential (test-FGL-seq) and the parallel (test-FGL-parallel) engines on each
+# matrix and prints one CSV line per run: the time is the one of the elimination only, as
+# reported by the engine, without loading the matrix.
+#
+# Run from the build directory (make benchmark-suite). The sweep is set with:
+#   SIZES       rows x columns of the matrices              (DEFAULT "5000x6000 10000x12000 20000x24000")
+#   THREADS     numbers of threads of the parallel engine   (DEFAULT "1 2 4 8")
+#   DENSITIES   densities per band of columns (-d)           (DEFAULT "0.005,0.01,0.03")
+#   PIVOT_RATIO fraction of the rows that are pivots (-a)    (DEFAULT 0.8)
+#   MODULUS     prime modulus (-p)                           (DEFAULT 65521)
+#   SEED        seed of the matrices (-r)                    (DEFAULT 1)
+#   FGL_OPTIONS options passed to both engines, e.g. "-r"    (DEFAULT none)
+#   WORK_DIR    where the matrices are written               (DEFAULT /tmp)
+
+SIZES=${SIZES:-"5000x6000 10000x12000 20000x24000"}
+THREADS=${THREADS:-"1 2 4 8"}
+DENSITIES=${DENSITIES:-"0.005,0.01,0.03"}
+PIVOT_RATIO=${PIVOT_RATIO:-0.8}
+MODULUS=${MODULUS:-65521}
+SEED=${SEED:-1}
+WORK_DIR=${WORK_DIR:-/tmp}
+
+for PROGRAM in generate-f4-matrix test-FGL-seq test-FGL-parallel
+do
+   if [ ! -x ./$PROGRAM ]; then
+      echo "$0: ./$PROGRAM not found, run make benchmark-suite from the build directory" >&2
+      exit 1
+   fi
+done
+
+# Prints "seconds,rank" from the output of a test program
+parse_run ()
+{
+   awk '/True rank/ { rank = $NF }
+        /Finished activity.*(FGL BLOC NEW METHOD|FG_LACHARTRE)$/ { sub(/.*rea: /, ""); sub(/s,.*/, ""); time = $0 }
+        END { printf "%s,%s", (time == "" ? "FAILED" : time), rank }'
+}
+
+echo "rows,columns,engine,threads,seconds,rank"
+
+for SIZE in $SIZES
+do
+   ROWS=${SIZE%x*}
+   COLUMNS=${SIZE#*x}
+   MATRIX="$WORK_DIR/fgl-benchmark-$ROWS-$COLUMNS-$SEED.f4"
+
+   if ! ./generate-f4-matrix -o "$MATRIX" -n $ROWS -m $COLUMNS -p $MODULUS -a $PIVOT_RATIO \
+         -d $DENSITIES -r $SEED > /dev/null 2>&1; then
+      echo "$0: cannot generate $MATRIX" >&2
+      exit 1
+   fi
+
+   echo "$ROWS,$COLUMNS,seq,1,`./test-FGL-seq -f "$MATRIX" $FGL_OPTIONS 2>&1 | parse_run`"
+
+   for T in $THREADS
+   do
+      echo "$ROWS,$COLUMNS,parallel,$T,`./test-FGL-parallel -f "$MATRIX" -p $T $FGL_OPTIONS 2>&1 | parse_run`"
+   done
+
+   rm -f "$MATRIX"
+done
@@ -0,0 +1,141 @@
+/*
+ * bloc-column-store.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Out-of-core storage of the bloc columns of a SparseBlocMatrix (B and D of the new method).
+ * spillAll () writes each column of blocs to a scratch file, unlinked as soon as it is created,
+ * and frees the blocs; the blocs themselves stay in the matrix, empty, so its shape is kept.
+ * A phase walking the columns in order acquire ()s the column it works on, which reads it back,
+ * and release ()s it, which lets at most max_resident columns stay in memory: the oldest ones
+ * used are evicted, and written back first if they were changed. prefetch () hands columns to
+ * a loader thread, which reads them while the current column is reduced; the columns it loads
+ * count in the bound, and it evicts the oldest released columns itself to make room for them.
+ * loadAll () reads back every column for the phases that need the whole matrix.
+ */
+
+#ifndef BLOC_COLUMN_STORE_H_
+#define BLOC_COLUMN_STORE_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "consts-macros.h"
+#include "types.h"
+
+template <typename BlocMatrix>
+class BlocColumnStore
+{
+public:
+	typedef typename BlocMatrix::BlocType Bloc;
+	typedef typename Bloc::IndexType Index;
+	typedef typename Bloc::ElementType Element;
+
+	/// Store of the columns of M in a scratch file of directory, keeping at most max_resident (at
+	/// least 1) of them in memory once spilled. The file is only created, and the columns of M
+	/// counted, by the first spillAll ()
+	BlocColumnStore (BlocMatrix& M, const char *directory, uint32 max_resident);
+	~BlocColumnStore ();
+
+	BlocMatrix& matrix () { return _M; }
+	uint32 nbColumns () const { return _columns.size (); }
+	uint32 maxResident () const { return _max_resident; }
+
+	/// Writes all the columns to the file and frees their blocs; throws std::runtime_error if the
+	/// file can't be created or written
+	void spillAll ();
+
+	/// Asks the loader thread to read column back once there is room for it
+	void prefetch (uint32 column);
+
+	/// Reads column back, unless it already is in memory, and keeps it there until release ()
+	void acquire (uint32 column);
+
+	/// The column may be evicted again; dirty if its blocs were changed since it was read
+	void release (uint32 column, bool dirty);
+
+	/// Reads back all the columns and keeps them; the store is not used afterwards
+	void loadAll ();
+
+	uint64 bytesWritten () const { return _bytes_written; }
+	uint64 bytesRead () const { return _bytes_read; }
+	uint32 nbEvictions () const { return _nb_evictions; }
+
+	/// Columns the loader thread had read before they were acquired
+	uint32 nbPrefetched () const { return _nb_prefetched; }
+
+private:
+	BlocColumnStore (const BlocColumnStore& other) {}
+
+	enum State
+	{
+		SPILLED,		//on the file only
+		LOADING,		//being read, by the loader thread or acquire ()
+		RESIDENT,		//in memory, not acquired
+		ACQUIRED,		//in memory, between acquire () and release ()
+		EVICTING		//being written back and freed
+	};
+
+	struct Column
+	{
+		State state;
+		bool dirty;
+		uint64 offset;			//where the column is on the file
+		uint64 length;			//bytes on the file, 0 while it was never written
+		uint64 last_use;		//release () count when it was released, 0 if not used since read
+	};
+
+	static void* loaderMain (void* p_store);
+
+	void openFile ();
+
+	/// Serializes the blocs of column to the file, reusing its place if it is large enough
+	void writeColumn (uint32 column);
+
+	/// Reads column from the file into its blocs
+	void readColumn (uint32 column);
+
+	/// Frees the blocs of column
+	void freeColumn (uint32 column);
+
+	/// Evicts the oldest released columns while more than nb_kept are in memory; called with
+	/// _lock held, which is released during the writes
+	void evict (uint32 nb_kept);
+
+	void writeAt (const void *buffer, size_t size, uint64 offset);
+	void readAt (void *buffer, size_t size, uint64 offset);
+
+	void stopLoader ();
+
+	BlocMatrix& _M;
+	std::vector<Column> _columns;
+	uint32 _max_resident;
+	uint32 _nb_resident;			//columns LOADING, RESIDENT, ACQUIRED or EVICTING
+	uint64 _nb_releases;
+
+	std::string _directory;
+	int _fd;
+	volatile uint64 _file_end;
+
+	std::deque<uint32> _queue;		//columns to prefetch
+	pthread_t _loader;
+	bool _loader_running;
+	bool _quit;
+
+	pthread_mutex_t _lock;
+	pthread_cond_t _cond;			//a column changed state, or a column was queued
+
+	volatile uint64 _bytes_written;
+	volatile uint64 _bytes_read;
+	uint32 _nb_evictions;
+	uint32 _nb_prefetched;
+};
+
+#include "bloc-column-store.C"
+
+#endif /* BLOC_COLUMN_STORE_H_ */
@@ -0,0 +1,78 @@
+/*
+ * concurrent-min-heap.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Binary min-heap shared between threads, protected by its own spinlock: push and popMin
+ * are O(log n). The lock keeps count of its acquisitions and of those that found it taken,
+ * to measure the contention on the heap.
+ */
+
+#ifndef CONCURRENT_MIN_HEAP_H_
+#define CONCURRENT_MIN_HEAP_H_
+
+#include <pthread.h>
+#include <vector>
+#include <functional>
+
+#include "consts-macros.h"
+
+/// Compare is a strict weak ordering, popMin returns the smallest element for it
+template <typename T, typename Compare = std::less<T> >
+class ConcurrentMinHeap
+{
+public:
+
+	ConcurrentMinHeap ();
+	~ConcurrentMinHeap ();
+
+	void push (const T& elt);
+
+	/// Takes the smallest element out of the heap, returns false if the heap is empty
+	bool popMin (T& elt);
+
+	bool empty () const { return _heap.empty (); }
+	size_t size () const { return _heap.size (); }
+
+	/// Empties the heap and resets the counters
+	void clear ();
+
+	/// Contention metrics
+	uint64 nbPushes () const { return _nb_pushes; }
+	uint64 nbPops () const { return _nb_pops; }
+	uint64 nbLockAcquisitions () const { return _nb_pushes + _nb_pop_attempts; }
+	uint64 nbLockContended () const { return _nb_contended; }
+	size_t maxSize () const { return _max_size; }
+
+private:
+	ConcurrentMinHeap (const ConcurrentMinHeap& other) {}
+
+	/// std::push_heap/pop_heap keep the greatest element on top, compare the other way around
+	struct ReverseCompare
+	{
+		Compare cmp;
+		bool operator() (const T& lhs, const T& rhs) const { return cmp (rhs, lhs); }
+	};
+
+	inline void lock ();
+	inline void unlock ();
+
+	std::vector<T> _heap;
+	ReverseCompare _cmp;
+
+	pthread_spinlock_t _lock;
+
+	//updated with the lock held
+	uint64 _nb_pushes;
+	uint64 _nb_pops;
+	uint64 _nb_pop_attempts;
+	uint64 _nb_contended;
+	size_t _max_size;
+};
+
+#include "concurrent-min-heap.C"
+
+#endif /* CONCURRENT_MIN_HEAP_H_ */
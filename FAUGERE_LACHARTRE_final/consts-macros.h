@@ -39,9 +39,6 @@ using namespace LELA;
 #define NB_ROWS_PER_MULTILINE 2
 #endif
 
-#if NB_ROWS_PER_MULTILINE != 2
-#error "NB_ROWS_PER_MULTILINE must be equal to 2. Other sizes are not supported in this version!"
-#endif
 
 //#ifndef NUM_THREADS
 //#define NUM_THREADS		2
@@ -59,6 +56,11 @@ using namespace LELA;
 #define NUM_THREADS_OMP_SLAVES_PER_MASTER		2
 #endif
 
+//rows each thread takes at a time when the indexer scans the heads of the rows
+#ifndef INDEXER_ROWS_PER_TASK
+#define INDEXER_ROWS_PER_TASK		1024
+#endif
+
 
 #define UNROLL_STEP__64		16
 #define UNROLL_STEP__16		16
@@ -71,16 +73,93 @@ using namespace LELA;
 #ifdef DEFAULT_BLOC_HEIGHT
 #if DEFAULT_BLOC_HEIGHT>=256
 	typedef uint16 IndexType;
-	std::string __IndexType__ = "uint16";
+	const std::string __IndexType__ = "uint16";
 #else
 	typedef uint8 IndexType;
-	std::string __IndexType__ = "uint8";
+	const std::string __IndexType__ = "uint8";
 #endif
 #else
 	typedef uint16 IndexType;
-	std::string __IndexType__ = "uint16";
+	const std::string __IndexType__ = "uint16";
 #endif
 
+/**
+ * Bloc sizes that can be selected at runtime. Each of them is a separate instantiation
+ * of the bloc kernels; DEFAULT_BLOC_SIZE is only the default choice.
+ */
+#define SUPPORTED_BLOC_SIZES	"64, 128, 256, 512"
+
+/**
+ * Index type of the entries of a bloc of a given size: column indexes inside blocs
+ * narrower than 256 fit on 8 bits.
+ */
+template <bool narrow_bloc>
+struct __BlocIndexTypeSelector
+{
+	typedef uint16 type;
+	static const char* name () { return "uint16"; }
+};
+
+template <>
+struct __BlocIndexTypeSelector<true>
+{
+	typedef uint8 type;
+	static const char* name () { return "uint8"; }
+};
+
+template <uint16 BlocSize>
+struct BlocIndexType : public __BlocIndexTypeSelector<(BlocSize < 256)> {};
+
+/**
+ * Multiply-accumulate of ring elements into the uint64 arrays used as dense accumulators.
+ *
+ * The product of two uint16 elements fits on 32 bits, so 2^32 products can be added
+ * before a uint64 accumulator overflows: no reduction is needed on the uint16 path.
+ * The product of two uint32 elements can reach 2^62, so after each addition the
+ * accumulator is checked for overflow and 2^64 mod p is added back when it wraps, which
+ * keeps it congruent to the exact sum modulo p (same schedule as ZpModule<uint32> in LELA).
+ */
+template <typename Element>
+struct ModularAccumulator;
+
+template <>
+struct ModularAccumulator<uint16>
+{
+	ModularAccumulator (const Modular<uint16>& R) {}
+
+	static inline uint32 mask (const uint64 x) { return x & 0x000000000000ffff; }
+
+	static inline void axpy (uint64& acc, const uint32 a, const uint32 x) { acc += a * x; }
+
+	static inline void mulmod (uint64& x, const uint32 a, const uint32 p) { x *= a; x %= p; }
+};
+
+template <>
+struct ModularAccumulator<uint32>
+{
+	uint64 two_64;		// 2^64 mod p
+
+	ModularAccumulator (const Modular<uint32>& R)
+	{
+		two_64 = 2;
+		for (int i = 0; i < 6; ++i)
+			two_64 = (two_64 * two_64) % R._modulus;
+	}
+
+	static inline uint32 mask (const uint64 x) { return x & 0x00000000ffffffff; }
+
+	inline void axpy (uint64& acc, const uint32 a, const uint32 x) const
+	{
+		const uint64 t = (uint64) a * x;
+
+		acc += t;
+		if (acc < t)
+			acc += two_64;
+	}
+
+	static inline void mulmod (uint64& x, const uint32 a, const uint32 p) { x = (x % p) * a % p; }
+};
+
 
 #define __PREFETCH_WRITE	1
 #define __PREFETCH_READ		0
@@ -116,6 +195,28 @@ using namespace LELA;
 	pthread_spin_lock(&lock##_spinlock_lock);	
 #endif							
 
+//Same as LOCK, also counts the acquisitions of the lock in lock##_nb_acquisitions and
+//those which found it taken in lock##_nb_contended (both updated with the lock held)
+#ifdef USE_MUTEX
+#define LOCK_COUNTING(lock)				\
+	do {						\
+		if(pthread_mutex_trylock(&lock##_mutex_lock) != 0) {	\
+			pthread_mutex_lock(&lock##_mutex_lock);	\
+			++lock##_nb_contended;		\
+		}					\
+		++lock##_nb_acquisitions;		\
+	} while(0)
+#else
+#define LOCK_COUNTING(lock)				\
+	do {						\
+		if(pthread_spin_trylock(&lock##_spinlock_lock) != 0) {	\
+			pthread_spin_lock(&lock##_spinlock_lock);	\
+			++lock##_nb_contended;		\
+		}					\
+		++lock##_nb_acquisitions;		\
+	} while(0)
+#endif
+
 #ifdef USE_MUTEX					
 #define UNLOCK(lock)					\
 	pthread_mutex_unlock(&lock##_mutex_lock);		
@@ -0,0 +1,58 @@
+/*
+ * dataflow-scheduler.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Runs tasks 0..nb_tasks-1 where a task may only depend on tasks with a smaller id.
+ * The tasks are handed out in increasing order; a thread running a task calls waitDone()
+ * on each task it depends on right before using its result, so it starts working as soon
+ * as its first dependency is done and keeps a single task in flight. Since the smallest
+ * task in progress always has all its dependencies done, the threads never deadlock.
+ */
+
+#ifndef DATAFLOW_SCHEDULER_H_
+#define DATAFLOW_SCHEDULER_H_
+
+#include <pthread.h>
+
+#include "consts-macros.h"
+
+class DataflowScheduler
+{
+public:
+
+	DataflowScheduler (uint32 nb_tasks);
+	~DataflowScheduler ();
+
+	/// Gets the next task in increasing order; returns false once all the tasks have been handed out
+	inline bool nextTask (uint32& task);
+
+	/// Blocks until task is done, task must have been handed out
+	inline void waitDone (uint32 task);
+
+	/// Marks task as done and wakes up the threads waiting for it
+	void taskDone (uint32 task);
+
+	uint32 nbTasks () const { return _nb_tasks; }
+
+	/// Number of times a thread had to block on a dependency, for reporting
+	uint32 nbWaits () const { return _nb_waits; }
+
+private:
+	DataflowScheduler (const DataflowScheduler& other) {}
+
+	uint32 _nb_tasks;
+	volatile uint32 _next_task;
+	volatile uint8 *_done;
+	uint32 _nb_waits;
+
+	pthread_mutex_t _lock;
+	pthread_cond_t _done_cond;
+};
+
+#include "dataflow-scheduler.C"
+
+#endif /* DATAFLOW_SCHEDULER_H_ */
@@ -0,0 +1,103 @@
+/*
+ * f4-file-stream.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Reads a matrix in the F4 binary format in two passes, without ever holding it in memory:
+ * 1. the constructor reads the row sizes and streams the positions section once to keep
+ *    the head (first column) of each row: 12 bytes per row. This is all the indexers need
+ *    to build the pivot and column maps (processMatrix).
+ * 2. readRows() reads a few given rows from the file; the indexers call it on each bloc of
+ *    rows right before writing it to the submatrices (constructSubMatrices).
+ *
+ * operator[] gives the size and the head of a row, with the interface of the rows of a
+ * SparseMatrix used by processMatrix: size (), empty (), front ().first.
+ */
+
+#ifndef F4_FILE_STREAM_H_
+#define F4_FILE_STREAM_H_
+
+#include "lela/matrix/sparse.h"
+#include "consts-macros.h"
+
+using namespace LELA;
+
+template <typename Element>
+class F4FileStream
+{
+public:
+	struct Head
+	{
+		uint32 first;
+	};
+
+	class RowHead
+	{
+	public:
+		RowHead (uint32 size, uint32 head) : _size (size) { _head.first = head; }
+
+		uint32 size () const { return _size; }
+		bool empty () const { return _size == 0; }
+		const Head& front () const { return _head; }
+
+		/// The rows are read again from the file, nothing to free
+		void free () const {}
+
+	private:
+		uint32 _size;
+		Head _head;
+	};
+
+	typedef const RowHead ConstRow;
+
+	/// Opens fileName and runs the first pass; throws if the values are not stored on sizeof(Element) bytes
+	F4FileStream (const char *fileName);
+	~F4FileStream ();
+
+	size_t rowdim () const { return _rowdim; }
+	size_t coldim () const { return _coldim; }
+	uint32 modulus () const { return _modulus; }
+	uint64 nnz () const { return _nnz; }
+
+	RowHead operator[] (size_t i) const
+	{
+		return RowHead ((uint32) (_row_offsets[i + 1] - _row_offsets[i]), _row_heads[i]);
+	}
+
+	/// Reads the rows rows_idxs[0..nb_rows-1] of the file to the rows 0..nb_rows-1 of out.
+	/// Can be called by several threads at once
+	void readRows (const uint32 *rows_idxs, uint32 nb_rows, SparseMatrix<Element>& out) const;
+
+	/// Number of bytes read from the file so far
+	uint64 bytesRead () const { return _bytes_read; }
+
+private:
+	F4FileStream (const F4FileStream& other) {}
+
+	/// pread of exactly size bytes at offset
+	void readAt (void *buffer, size_t size, uint64 offset) const;
+
+	int _fd;
+
+	uint32 _rowdim;
+	uint32 _coldim;
+	uint32 _modulus;
+	uint64 _nnz;
+
+	//offsets of the sections in the file
+	uint64 _values_offset;
+	uint64 _positions_offset;
+
+	/// _row_offsets[i] is the index of the first entry of row i in the values and positions sections
+	uint64 *_row_offsets;
+	uint32 *_row_heads;
+
+	mutable volatile uint64 _bytes_read;
+};
+
+#include "f4-file-stream.C"
+
+#endif /* F4_FILE_STREAM_H_ */
@@ -0,0 +1,96 @@
+/*
+ * f4-matrix-generator.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Random matrices with the structure of the matrices of F4: every row starts with a 1 on its
+ * head column and is sparse on its right. nb_pivots = pivot_ratio * rowdim columns are the heads
+ * of the pivot rows (A|B); they form a staircase spread over the first staircase_width * coldim
+ * columns. The other rows (C|D) start on one of these pivot columns as well, so the indexer finds
+ * exactly nb_pivots pivots: A is nb_pivots x nb_pivots, B nb_pivots x (coldim - nb_pivots), C and D
+ * have the remaining rows.
+ * The right of the head of a row is filled with the density of its band of columns: the columns
+ * are cut in band_densities.size () bands of equal width, from left to right.
+ * The rows are shuffled; the same parameters and seed always give the same matrix.
+ */
+
+#ifndef F4_MATRIX_GENERATOR_H_
+#define F4_MATRIX_GENERATOR_H_
+
+#include <vector>
+
+#include "types.h"
+#include "lela/matrix/sparse.h"
+
+using namespace LELA;
+
+struct F4GeneratorParams
+{
+	uint32 rowdim;
+	uint32 coldim;
+	uint32 modulus;
+
+	/// Fraction of the rows that are pivots (rows of A)
+	double pivot_ratio;
+	/// Fraction of the columns the heads of the pivots are spread over; 1 for the whole width
+	double staircase_width;
+	/// Density of the entries right of the head, per band of columns from left to right
+	std::vector<double> band_densities;
+
+	uint32 seed;
+
+	F4GeneratorParams ()
+		: rowdim (10000), coldim (12000), modulus (65521), pivot_ratio (0.8), staircase_width (0.9),
+		  band_densities (1, 0.01), seed (1) {}
+};
+
+class F4MatrixGenerator
+{
+public:
+
+	/// Number of pivots of the matrix generated with params
+	static uint32 nbPivots (const F4GeneratorParams& params);
+
+	/// Generates the matrix into A; throws std::invalid_argument if params can't be met
+	template <typename Element>
+	static void generate (const F4GeneratorParams& params, SparseMatrix<Element>& A);
+
+	/// Parses a comma separated list of densities ("0.01,0.05,0.2") into densities; false if it is not one
+	static bool parseDensities (const char *list, std::vector<double>& densities);
+
+private:
+	F4MatrixGenerator () {}
+	F4MatrixGenerator (const F4MatrixGenerator& other) {}
+
+	/// xorshift64*: the same sequence on every platform, unlike rand ()
+	struct Random
+	{
+		uint64 state;
+
+		Random (uint64 seed) : state (seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+		inline uint64 next ()
+		{
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return state * 0x2545F4914F6CDD1DULL;
+		}
+
+		/// Uniform in [0, n[
+		inline uint32 below (uint32 n) { return (uint32) (next () % n); }
+
+		/// Uniform in ]0, 1]
+		inline double unit () { return ((next () >> 11) + 1) * (1.0 / 9007199254740992.0); }
+	};
+
+	/// Number of columns to skip before the next entry of a band of the given density
+	static uint32 gap (Random& random, double density);
+};
+
+#include "f4-matrix-generator.C"
+
+#endif /* F4_MATRIX_GENERATOR_H_ */
@@ -0,0 +1,126 @@
+/*
+ * f4-matrix-view.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Read only matrix over a file in the F4 binary format mapped in memory. The rows are views
+ * on the values and positions sections of the file: nothing is copied, the pages are read on
+ * demand and can be dropped by the kernel under memory pressure.
+ * Only the offset of each row (8 bytes per row) is kept in memory.
+ *
+ * The rows have the interface of the rows of a SparseMatrix used by the indexers:
+ * size (), empty (), front () and const_iterator with ->first (column) and ->second (value).
+ */
+
+#ifndef F4_MATRIX_VIEW_H_
+#define F4_MATRIX_VIEW_H_
+
+#include "consts-macros.h"
+
+template <typename Element>
+class F4MatrixView
+{
+public:
+	//the sections of the file are not aligned on the size of their entries
+	typedef uint32 UnalignedIndex __attribute__((aligned(1)));
+	typedef Element UnalignedElement __attribute__((aligned(1)));
+
+	struct Entry
+	{
+		uint32 first;
+		Element second;
+	};
+
+	class const_iterator
+	{
+	public:
+		const_iterator () : _pos (NULL), _val (NULL) {}
+
+		const_iterator (const UnalignedIndex *pos, const UnalignedElement *val)
+			: _pos (pos), _val (val) {}
+
+		const Entry& operator* () const
+		{
+			_entry.first = *_pos;
+			_entry.second = *_val;
+			return _entry;
+		}
+
+		const Entry* operator-> () const { return &**this; }
+
+		const_iterator& operator++ () { ++_pos; ++_val; return *this; }
+
+		bool operator== (const const_iterator& other) const { return _pos == other._pos; }
+		bool operator!= (const const_iterator& other) const { return _pos != other._pos; }
+
+	private:
+		const UnalignedIndex *_pos;
+		const UnalignedElement *_val;
+		mutable Entry _entry;
+	};
+
+	class Row
+	{
+	public:
+		typedef typename F4MatrixView::const_iterator const_iterator;
+
+		Row (const UnalignedIndex *pos, const UnalignedElement *val, uint32 size)
+			: _pos (pos), _val (val), _size (size) {}
+
+		const_iterator begin () const { return const_iterator (_pos, _val); }
+		const_iterator end () const { return const_iterator (_pos + _size, _val + _size); }
+
+		uint32 size () const { return _size; }
+		bool empty () const { return _size == 0; }
+		Entry front () const { return *begin (); }
+
+		/// The data belongs to the file, nothing to free
+		void free () const {}
+
+	private:
+		const UnalignedIndex *_pos;
+		const UnalignedElement *_val;
+		uint32 _size;
+	};
+
+	typedef const Row ConstRow;
+
+	/// Maps fileName; throws if the file can't be mapped or if its values are not stored on sizeof(Element) bytes
+	F4MatrixView (const char *fileName);
+	~F4MatrixView ();
+
+	size_t rowdim () const { return _rowdim; }
+	size_t coldim () const { return _coldim; }
+	uint32 modulus () const { return _modulus; }
+	uint64 nnz () const { return _nnz; }
+	size_t fileSize () const { return _file_size; }
+
+	Row operator[] (size_t i) const
+	{
+		return Row (_positions + _row_offsets[i], _values + _row_offsets[i], (uint32) (_row_offsets[i + 1] - _row_offsets[i]));
+	}
+
+private:
+	F4MatrixView (const F4MatrixView& other) {}
+
+	void *_map;
+	size_t _file_size;
+
+	uint32 _rowdim;
+	uint32 _coldim;
+	uint32 _modulus;
+	uint64 _nnz;
+
+	const UnalignedElement *_values;
+	const UnalignedIndex *_positions;
+
+	/// _row_offsets[i] is the index of the first entry of row i in the values and positions sections
+	uint64 *_row_offsets;
+};
+
+#include "f4-matrix-view.C"
+
+#endif /* F4_MATRIX_VIEW_H_ */
@@ -0,0 +1,151 @@
+/*
+ * fgl-engine.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * The parallel Faugère-Lachartre elimination as a library: indexer, C = A^-1 C (or B = A^-1 B
+ * with the standard method), D = D - C*B, echelonize D, inner indexer and reconstruction of
+ * the matrix, then the second round when a reduced form is asked.
+ *
+ * An engine is built once over a ring with its options and can then be called on any number
+ * of matrices. The worker threads and their scratch buffers (see worker-pool.h) are created
+ * by the constructor and reused by all the calls.
+ */
+
+#ifndef FGL_ENGINE_H_
+#define FGL_ENGINE_H_
+
+#include "consts-macros.h"
+#include "types.h"
+#include "matrix-utils.h"
+#include "level3-ops.h"
+#include "level3Parallel.h"
+#include "level3Parallel-gf2.h"
+#include "level3Parallel-small-prime.h"
+#include "level3Parallel_echelon.h"
+#include "indexer_parallel.h"
+#include "worker-pool.h"
+#include "representation-cost-model.h"
+#include "phase-profiler.h"
+#include "memory-accounting.h"
+#include "bloc-column-store.h"
+
+#include "lela/matrix/sparse.h"
+
+using namespace LELA;
+
+struct FGLOptions
+{
+	/// Number of threads of the parallel phases
+	int nb_threads;
+	/// Compute the reduced row echelon form; only an echelon form otherwise
+	bool reduced;
+	/// Use the standard Faugère-Lachartre (B = A^-1 B) instead of the new method (C = A^-1 C)
+	bool standard_method;
+	/// One of SUPPORTED_BLOC_SIZES, or 0 to choose it from the shape of each matrix
+	int bloc_size;
+	/// Free the parts of the matrices as soon as they are not used anymore
+	bool free_memory_on_the_go;
+	/// Sparse/dense cost profile loaded (or measured and saved) by the constructor, NULL for the default threshold
+	const char *cost_profile;
+	/// Density of D from which it is echelonized as a dense matrix (see Level3ParallelEchelon::echelonize__Dense), 0 to never do it
+	float dense_echelon_threshold;
+	/// Bytes the structures of the engine may hold (see MemoryAccounting), 0 for no limit. Sets
+	/// free_memory_on_the_go, and D is echelonized as a dense matrix only if its copy fits
+	uint64 mem_budget;
+	/// Directory of a scratch file where B and D wait while C is reduced, D = D - C*B then
+	/// streaming their bloc columns (see BlocColumnStore); NULL to keep them in memory. New method only
+	const char *out_of_core_dir;
+	/// Bloc columns of B, and of D, in memory at once during the out-of-core D = D - C*B
+	uint32 out_of_core_columns;
+	/// Reduce the blocs of the matrices of modulus 2 with the bit-packed kernels of
+	/// Level3ParallelGF2Ops (B = A^-1 B and D = D - C*B, in memory and not horizontal)
+	bool gf2_kernels;
+	/// Reduce the blocs of the matrices of modulus below 2^8 on uint8 blocs with uint32
+	/// accumulators, see Level3ParallelSmallPrimeOps (same cases as gf2_kernels)
+	bool small_prime_kernels;
+
+	/// [DEBUG] Reduce D horizontally (row major then column)
+	bool horizontal;
+	/// [DEBUG] Reconstruct the matrix from A converted to blocs (new method)
+	bool reconstruct_old;
+
+	FGLOptions ()
+		: nb_threads (8), reduced (false), standard_method (false), bloc_size (0),
+		  free_memory_on_the_go (true), cost_profile (NULL),
+		  dense_echelon_threshold (DENSE_ECHELON_THRESHOLD), mem_budget (0),
+		  out_of_core_dir (NULL), out_of_core_columns (4), gf2_kernels (true),
+		  small_prime_kernels (true),
+		  horizontal (false), reconstruct_old (false)
+	{}
+};
+
+template <typename Ring>
+class FGLEngine
+{
+public:
+	typedef typename Ring::Element Element;
+
+	/// Throws std::invalid_argument if options.bloc_size is not supported, or if the out-of-core
+	/// mode is asked for with the standard method
+	FGLEngine (const Ring& R, const FGLOptions& options = FGLOptions ());
+
+	/**
+	 * Computes an echelon form of M, reduced if options ().reduced is set, into A and returns
+	 * the rank. M is a SparseMatrix (A itself can be given, it is then overwritten), an
+	 * F4MatrixView or an F4FileStream; its rows are freed on the go if free_memory_on_the_go is set.
+	 * The rows of a non reduced echelon form are in descending order of their first column.
+	 * Throws MemoryBudgetExceeded at the end of the first phase that went past options ().mem_budget
+	 */
+	template <typename SourceMatrix>
+	size_t echelonize (SourceMatrix& M, SparseMatrix<Element>& A);
+
+	const Ring& ring () const { return _R; }
+	const FGLOptions& options () const { return _options; }
+
+	/// Bloc size used by the last call to echelonize
+	uint16 lastBlocSize () const { return _last_bloc_size; }
+
+	static bool isSupportedBlocSize (int bloc_size);
+
+private:
+	template <uint16 BlocSize, typename SourceMatrix>
+	size_t echelonize_standard_method (SourceMatrix& M, SparseMatrix<Element>& A);
+
+	template <uint16 BlocSize, typename SourceMatrix>
+	size_t echelonize_new_method (SourceMatrix& M, SparseMatrix<Element>& A);
+
+	/// Echelonizes D into D_multiline, as a dense matrix if it is dense enough; returns its rank
+	template <typename Index, uint16 BlocSize>
+	size_t echelonize_D (SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
+			SparseMultilineMatrix<Element>& D_multiline);
+
+	/// B = A^-1 B, on the GF(2) or small prime kernels when they apply
+	template <typename Index, uint16 BlocSize>
+	void reducePivotsByPivots (const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
+
+	/// D = D - C*B, on the GF(2) or small prime kernels when they apply; on the generic kernels
+	/// the rows of B the cost profile selects are laid out as bitmaps during the product
+	template <typename Index, uint16 BlocSize>
+	void reduceNonPivotsByPivots (const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
+			bool invert_scalars);
+
+	//the GF(2) and small prime kernels pair the rows two by two
+	bool useGF2Kernels () const { return NB_ROWS_PER_MULTILINE == 2 && _options.gf2_kernels && _R._modulus == 2; }
+	bool useSmallPrimeKernels () const
+		{ return NB_ROWS_PER_MULTILINE == 2 && _options.small_prime_kernels && Level2OpsSmallPrime::supports (_R._modulus); }
+
+	const Ring _R;
+	FGLOptions _options;
+	uint16 _last_bloc_size;
+};
+
+#include "fgl-engine.C"
+
+#endif /* FGL_ENGINE_H_ */
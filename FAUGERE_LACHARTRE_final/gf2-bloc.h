@@ -0,0 +1,111 @@
+/*
+ * gf2-bloc.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Bloc of a matrix over GF(2), one bit per entry: the counterpart of SparseMultilineBloc for
+ * the matrices of modulus 2. A bloc is stored either sparse, the column indexes of the ones of
+ * its BlocSize lines one line after the other, or dense, a tile of BlocSize lines of
+ * BlocSize / 64 words, whichever takes less room.
+ * The blocs are built from a tile of words (assign ()), the form the kernels of Level2OpsGF2
+ * accumulate in; readTile () and writeTile () convert between such a tile and a
+ * SparseMultilineBloc over Modular<Element> modulo 2, as built by the indexer.
+ */
+
+#ifndef GF2_BLOC_H_
+#define GF2_BLOC_H_
+
+#include "consts-macros.h"
+#include "types.h"
+#include "arena-array.h"
+
+template <typename Index = uint16, uint16 BlocSize = DEFAULT_BLOC_SIZE>
+class GF2Bloc
+{
+public:
+	typedef Index IndexType;
+
+	enum { BLOC_HEIGHT = BlocSize, BLOC_WIDTH = BlocSize, WORDS = BlocSize / 64 };
+
+	static_assert (BlocSize % 64 == 0, "bloc size must be a multiple of 64");
+
+	GF2Bloc () : _dense (false), _nb_ones (0) {}
+
+	/// Replaces the content by the BlocSize lines of WORDS words of tile
+	void assign (uint64 * const *tile);
+
+	/// Writes the bloc to the BlocSize lines of WORDS words of tile
+	void expand (uint64 **tile) const;
+
+	/// XORs the line of the bloc to the WORDS words of acc
+	inline void xorLine (uint32 line, uint64 *acc) const
+	{
+		if(_dense)
+		{
+			const uint64 *w = &_words[line * WORDS];
+
+			for(uint32 i = 0; i < WORDS; ++i)
+				acc[i] ^= w[i];
+		}
+		else
+		{
+			for(uint32 p = _starts[line]; p < _starts[line + 1]; ++p)
+				acc[_indexes[p] / 64] ^= 1ULL << (_indexes[p] % 64);
+		}
+	}
+
+	/// Number of ones of the line, for the cost of xorLine
+	inline uint32 lineSize (uint32 line) const
+	{
+		return _dense ? (uint32) BlocSize : (uint32) (_starts[line + 1] - _starts[line]);
+	}
+
+	bool	empty	()	const	{ return _nb_ones == 0; }
+	bool	isDense	()	const	{ return _dense; }
+	uint32	nbOnes	()	const	{ return _nb_ones; }
+
+	/// Words of the line of a dense bloc
+	const uint64* denseLine (uint32 line) const { return &_words[line * WORDS]; }
+
+	/// Column indexes of the ones of the line of a sparse bloc
+	const Index* lineBegin (uint32 line) const	{ return &_indexes[0] + _starts[line]; }
+	const Index* lineEnd (uint32 line) const	{ return &_indexes[0] + _starts[line + 1]; }
+
+	void free (bool deep = false)
+	{
+		_words.release ();
+		_starts.release ();
+		_indexes.release ();
+		_dense = false;
+		_nb_ones = 0;
+	}
+
+	size_t memoryUsage () const
+	{
+		return sizeof (*this) + _words.ownedBytes () + _starts.ownedBytes () + _indexes.ownedBytes ();
+	}
+
+	/// Writes the BlocSize lines of bloc, whose non zero values are the ones, to tile
+	template <typename Element>
+	static void readTile (const SparseMultilineBloc<Element, Index, BlocSize>& bloc, uint64 **tile);
+
+	/// Replaces the rows of bloc by the lines of tile, with values 0 and 1, in one arena; each
+	/// row sparse or dense as HybridRepresentation decides
+	template <typename Element>
+	static void writeTile (uint64 * const *tile, SparseMultilineBloc<Element, Index, BlocSize>& bloc);
+
+private:
+	bool _dense;
+	uint32 _nb_ones;
+
+	ArenaArray<uint64> _words;		//dense: the BlocSize lines of WORDS words
+	ArenaArray<uint16> _starts;		//sparse: where each line starts in _indexes, and where the last one ends
+	ArenaArray<Index> _indexes;		//sparse: the columns of the ones
+};
+
+#include "gf2-bloc.C"
+
+#endif /* GF2_BLOC_H_ */
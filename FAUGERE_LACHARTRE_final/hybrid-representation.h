@@ -0,0 +1,92 @@
+/*
+ * hybrid-representation.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Choice between the sparse (indexes + values), bitmap (one bit per column + values) and dense
+ * (all the values) layouts of the multiline rows: a row is stored sparse when its density is
+ * below threshold (), and the rows of B read by D = D - C*B are laid out as bitmaps for that
+ * phase when their density is between bitmapThreshold () and threshold (). The thresholds are
+ * HYBRID_REPRESENTATION_THRESHOLD, and no bitmap, until a cost profile sets them (see
+ * representation-cost-model.h). The rows written by the kernels are counted by layout so that
+ * each phase can report its mix.
+ */
+
+#ifndef HYBRID_REPRESENTATION_H_
+#define HYBRID_REPRESENTATION_H_
+
+#include "consts-macros.h"
+
+class HybridRepresentation
+{
+public:
+	/// Density (entries / width) under which a row is stored sparse
+	static inline float threshold () { return _threshold (); }
+
+	static void setThreshold (float threshold);
+
+	/// Density from which a sparse row is laid out as a bitmap; threshold () or more for none
+	static inline float bitmapThreshold () { return _bitmap_threshold (); }
+
+	static void setBitmapThreshold (float threshold);
+
+	/// Whether a sparse row of width columns with nb_entries non zero columns is laid out as a bitmap
+	static inline bool isBitmap (uint32 nb_entries, uint32 width)
+	{
+		const float density = (float) nb_entries / (float) width;
+
+		return density >= bitmapThreshold () && density < threshold ();
+	}
+
+	/// Whether some rows are laid out as bitmaps
+	static inline bool useBitmaps () { return bitmapThreshold () < threshold (); }
+
+	/// Whether a row of width columns with nb_entries non zero columns is stored sparse
+	static inline bool isSparse (uint32 nb_entries, uint32 width)
+	{
+		return (float) nb_entries / (float) width < threshold ();
+	}
+
+	/// Adds rows written sparse, dense and as bitmaps to the mix of the current phase; thread safe
+	static inline void count (uint64 nb_sparse, uint64 nb_dense, uint64 nb_bitmap = 0)
+	{
+		__sync_fetch_and_add (&_nb_rows ()[0], nb_sparse);
+		__sync_fetch_and_add (&_nb_rows ()[1], nb_dense);
+		__sync_fetch_and_add (&_nb_rows ()[2], nb_bitmap);
+	}
+
+	/// Reports the mix counted since the last call under the name phase and resets it
+	static void reportMix (const char *phase);
+
+	static inline void resetMix () { _nb_rows ()[0] = 0; _nb_rows ()[1] = 0; _nb_rows ()[2] = 0; }
+
+private:
+	HybridRepresentation () {}
+	HybridRepresentation (const HybridRepresentation& other) {}
+
+	static inline float& _threshold ()
+	{
+		static float threshold = HYBRID_REPRESENTATION_THRESHOLD;
+		return threshold;
+	}
+
+	static inline float& _bitmap_threshold ()
+	{
+		static float threshold = HYBRID_REPRESENTATION_THRESHOLD;
+		return threshold;
+	}
+
+	/// Rows written sparse, rows written dense, rows laid out as bitmaps
+	static inline volatile uint64* _nb_rows ()
+	{
+		static volatile uint64 nb_rows[3] = { 0, 0, 0 };
+		return nb_rows;
+	}
+};
+
+#include "hybrid-representation.C"
+
+#endif /* HYBRID_REPRESENTATION_H_ */
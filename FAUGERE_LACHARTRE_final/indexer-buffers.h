@@ -0,0 +1,68 @@
+/*
+ * indexer-buffers.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Arrays of indexes of the indexers (the column maps, their reverse maps and the row indexes),
+ * kept when an indexer frees them and handed to the next indexer that asks for an array at most
+ * as large. When many matrices are echelonized in one process, the indexers of a matrix thus
+ * reuse the arrays of the previous ones instead of allocating and freeing them.
+ */
+
+#ifndef INDEXER_BUFFERS_H_
+#define INDEXER_BUFFERS_H_
+
+#include <map>
+#include <pthread.h>
+
+#include "types.h"
+#include "memory-accounting.h"
+
+class IndexerBuffers
+{
+public:
+
+	/// An array of at least size entries, of undefined content
+	static uint32* acquire (size_t size);
+
+	/// Gives back an array returned by acquire (); NULL is ignored
+	static void release (uint32 *array);
+
+	/// Frees the arrays given back
+	static void clear ();
+
+	/// Arrays allocated, and arrays handed out again, since the start
+	static uint64 nbAllocations ();
+	static uint64 nbReuses ();
+
+	/// Bytes of the arrays handed out and given back, also counted by MemoryAccounting
+	static uint64 bytesHeld ();
+
+private:
+	IndexerBuffers () {}
+	IndexerBuffers (const IndexerBuffers& other) {}
+
+	struct Pool
+	{
+		//free arrays by size, and sizes of the arrays handed out
+		std::multimap<size_t, uint32 *> free;
+		std::map<uint32 *, size_t> used;
+
+		uint64 nb_allocations;
+		uint64 nb_reuses;
+		uint64 bytes;
+		pthread_mutex_t lock;
+
+		Pool () : nb_allocations (0), nb_reuses (0), bytes (0) { pthread_mutex_init (&lock, NULL); }
+		~Pool ();
+	};
+
+	static Pool& _pool ();
+};
+
+#include "indexer-buffers.C"
+
+#endif /* INDEXER_BUFFERS_H_ */
@@ -11,13 +11,14 @@
 #define INDEXER_H_
 
 #include "consts-macros.h"
+#include "f4-file-stream.h"
 
 #include "lela/util/debug.h"
 #include "lela/util/commentator.h"
 
 using namespace LELA;
 
-template<typename Element, typename Index>
+template<typename Element, typename Index, uint16 BlocSize = DEFAULT_BLOC_SIZE>
 class SequentialIndexer
 {
 private:
@@ -167,25 +168,28 @@ public:
 	 * Constructs the maps of indexes of the original matrix.
 	 * Identifies the list of pivot/non pivot rows, pivot/non pivot columns and their reverse maps
 	 * (reverse map is the correspondance from indexes in sub matrices to the original matrix)
+	 * SourceMatrix is a SparseMatrix<Element> or an F4MatrixView<Element> (matrix file mapped in memory)
 	 */
-	void processMatrix(const SparseMatrix<Element>& M)
+	template <typename SourceMatrix>
+	void processMatrix(const SourceMatrix& M)
 	{
 		this->coldim = M.coldim ();
 		this->rowdim = M.rowdim ();
 
-		typename SparseMatrix<Element>::ConstRowIterator i_M;
-		uint32 curr_row_idx = 0, entry;
+		uint32 curr_row_idx, entry;
 
 		initArrays(this->rowdim, this->coldim);
 
 		Npiv = 0;
 
 		//Sweeps the rows to identify the row pivots and column pivots
-		for (i_M = M.rowBegin (); i_M != M.rowEnd (); ++i_M)
+		for (curr_row_idx = 0; curr_row_idx < this->rowdim; ++curr_row_idx)
 		{
-			if(!i_M->empty ())
+			typename SourceMatrix::ConstRow& row = M[curr_row_idx];
+
+			if(!row.empty ())
 			{
-				entry = i_M->front ().first;
+				entry = row.front ().first;
 				if(pivot_rows_idxs_by_entry[entry] == MINUS_ONE)
 				{
 					pivot_rows_idxs_by_entry[entry] = curr_row_idx;
@@ -194,7 +198,7 @@ public:
 				else	//choose the least sparse row //ELGAB Sylvain
 				{
 					//check if the pivot is less dense. replace it with this one
-					if(M[pivot_rows_idxs_by_entry[entry]].size () > i_M->size ())
+					if(M[pivot_rows_idxs_by_entry[entry]].size () > row.size ())
 					{
 						non_pivot_rows_idxs[pivot_rows_idxs_by_entry[entry]] = pivot_rows_idxs_by_entry[entry];
 						pivot_rows_idxs_by_entry[entry] = curr_row_idx;
@@ -205,8 +209,6 @@ public:
 			}
 			else
 				non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-
-			++curr_row_idx;
 		}
 
 		//construct the column pivots (non column pivots) map and its reverse map
@@ -249,42 +251,40 @@ public:
 
 		typename SparseMultilineMatrix<Element>::ConstRowIterator i_M;
 		uint32 curr_row_idx = 0;
-		long h1, h2;
-		uint32 h1_idx, h2_idx;
-		Element h1_val, h2_val;
+		long h;
+		uint32 h_idx;
+		Element h_val;
 
-		//In case there is a null line at the end of a multiline
-		initArrays(this->rowdim + this->rowdim % M.nb_lines_per_bloc (), this->coldim);
+		//In case there are null lines at the end of the last multiline
+		initArrays(M.multiline_rowdim () * M.nb_lines_per_bloc (), this->coldim);
 
 		Npiv = 0;
 
 		//Sweeps the rows to identify the row pivots and column pivots
 		for (i_M = M.rowBegin (); i_M != M.rowEnd (); ++i_M)
 		{
-			if(!i_M->empty ())
+			for (uint16 l = 0; l < NB_ROWS_PER_MULTILINE; ++l)
 			{
-				h1 = Level1Ops::headMultiLineVectorHybrid(*i_M, 0, h1_val, h1_idx, M.coldim());
-				h2 = Level1Ops::headMultiLineVectorHybrid(*i_M, 1, h2_val, h2_idx, M.coldim());
+				h = i_M->empty () ? -1 : Level1Ops::headMultiLineVectorHybrid(*i_M, l, h_val, h_idx, M.coldim());
 
-				//LINE 1
-				if(h1 == -1)	//empty line
+				if(h == -1)	//empty line
 				{
 					non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
 				}
 				else
 				{
-					if(pivot_rows_idxs_by_entry[h1] == MINUS_ONE)		//non empty
+					if(pivot_rows_idxs_by_entry[h] == MINUS_ONE)		//non empty
 					{
-						pivot_rows_idxs_by_entry[h1] = curr_row_idx;
+						pivot_rows_idxs_by_entry[h] = curr_row_idx;
 						Npiv++;
 					}
 					else		//TODO New choose the least sparse row //ELGAB Sylvain
 					{
 						//check if the pivot is less dense. replace it with this one
-						/*if(M[pivot_rows_idxs_by_entry[h1]].size () > i_M->size ())
+						/*if(M[pivot_rows_idxs_by_entry[h]].size () > i_M->size ())
 						{
-							non_pivot_rows_idxs[pivot_rows_idxs_by_entry[h1]] = pivot_rows_idxs_by_entry[h1];
-							pivot_rows_idxs_by_entry[h1] = curr_row_idx;
+							non_pivot_rows_idxs[pivot_rows_idxs_by_entry[h]] = pivot_rows_idxs_by_entry[h];
+							pivot_rows_idxs_by_entry[h] = curr_row_idx;
 							//Npiv++;
 						}
 						else*/
@@ -293,39 +293,6 @@ public:
 				}
 
 				++curr_row_idx;
-				//LINE 2
-				if(h2 == -1)	//empty line
-				{
-					non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-				}
-				else
-				{
-					if(pivot_rows_idxs_by_entry[h2] == MINUS_ONE)
-					{
-						pivot_rows_idxs_by_entry[h2] = curr_row_idx;
-						Npiv++;
-					}
-					else		//TODO New choose the least sparse row //ELGAB Sylvain
-					{
-						//check if the pivot is less dense. replace it with this one
-						/*if(M[pivot_rows_idxs_by_entry[h2]].size () > i_M->size ())
-						{
-							non_pivot_rows_idxs[pivot_rows_idxs_by_entry[h2]] = pivot_rows_idxs_by_entry[h2];
-							pivot_rows_idxs_by_entry[h2] = curr_row_idx;
-							//Npiv++;
-						}
-						else*/
-						non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-					}
-				}
-
-				++curr_row_idx;
-			}
-			else		//multiline is empty
-			{
-				non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-				non_pivot_rows_idxs[curr_row_idx+1] = curr_row_idx+1;
-				curr_row_idx += 2;
 			}
 		}
 
@@ -360,14 +327,62 @@ public:
 		_index_maps_constructed = true;
 	}
 
-	void write_row_blocs_to_Left_Right_matrix(const SparseMatrix<Element>& M,
-												SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-												SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	/// Second pass of the streaming mode: the rows of the bloc are read from the file right before being written
+	void write_row_blocs_to_Left_Right_matrix(const F4FileStream<Element>& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 *rows_idxs,
+			uint32 nb_rows,
+			uint32 row_bloc_idx)
+	{
+		SparseMatrix<Element> rows (nb_rows, M.coldim ());
+		uint32 local_rows_idxs[nb_rows];
+
+		M.readRows (rows_idxs, nb_rows, rows);
+		for (uint32 j = 0; j < nb_rows; ++j)
+			local_rows_idxs[j] = j;
+
+		write_row_blocs_to_Left_Right_matrix(rows, A, B, local_rows_idxs, nb_rows, row_bloc_idx);
+	}
+
+	/// Returns the smallest column over the iterators of the nb_lines rows of a multiline, MINUS_ONE
+	/// when all the rows are read; values gets the entry of each line at that column (0 if none)
+	/// and the iterators sitting on it are advanced
+	template <typename Iterator>
+	static inline uint32 nextMultilineColumn(Iterator *its, const Iterator *its_end, uint32 nb_lines, Element *values)
+	{
+		uint32 col = MINUS_ONE;
+
+		for (uint32 l = 0; l < nb_lines; ++l)
+			if (its[l] != its_end[l] && its[l]->first < col)
+				col = its[l]->first;
+
+		if (col == MINUS_ONE)
+			return MINUS_ONE;
+
+		for (uint32 l = 0; l < NB_ROWS_PER_MULTILINE; ++l)
+		{
+			if (l < nb_lines && its[l] != its_end[l] && its[l]->first == col)
+			{
+				values[l] = its[l]->second;
+				++its[l];
+			}
+			else
+				values[l] = 0;
+		}
+
+		return col;
+	}
+
+	template <typename SourceMatrix>
+	void write_row_blocs_to_Left_Right_matrix(const SourceMatrix& M,
+												SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+												SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 												uint32 *rows_idxs,
 												uint32 nb_rows,
 												uint32 row_bloc_idx)
 	{
-		typename SparseVector<Element>::const_iterator it1, it2;
+		typename SourceMatrix::Row::const_iterator it1, it2;
 
 		A[row_bloc_idx].clear ();
 		B[row_bloc_idx].clear ();
@@ -397,6 +412,53 @@ public:
 			B[row_bloc_idx][k].init(B.bloc_height (), B.bloc_width ());
 
 		//2. write elements to blocs
+#if NB_ROWS_PER_MULTILINE != 2
+		typename SourceMatrix::Row::const_iterator its[NB_ROWS_PER_MULTILINE], its_end[NB_ROWS_PER_MULTILINE];
+		Element values[NB_ROWS_PER_MULTILINE];
+		std::vector<Element> values_stack;
+		uint32 col, nb_lines;
+
+		for(uint32 i=0; i<nb_rows; i+=NB_ROWS_PER_MULTILINE)
+		{
+			nb_lines = MIN(NB_ROWS_PER_MULTILINE, nb_rows - i);
+
+			for(uint32 l=0; l<nb_lines; ++l)
+			{
+				its[l] = M[rows_idxs[i+l]].begin ();
+				its_end[l] = M[rows_idxs[i+l]].end ();
+			}
+
+			idx_stack_elt_idx_in_line.clear();
+			idx_stack_bloc.clear();
+			values_stack.clear();
+
+			line_idx_in_bloc = i/NB_ROWS_PER_MULTILINE;
+
+			while ((col = nextMultilineColumn(its, its_end, nb_lines, values)) != MINUS_ONE)
+			{
+				if(pivot_columns_map[col] != MINUS_ONE)		//pivot column
+				{
+					bloc_idx_in_row = (A.coldim () - 1 - pivot_columns_map[col] - A.FirstBlocsColumIndexes[row_bloc_idx]) / A.bloc_width();
+					elt_idx_in_line = (A.coldim () - 1 - pivot_columns_map[col] - A.FirstBlocsColumIndexes[row_bloc_idx]) % A.bloc_width();
+
+					idx_stack_elt_idx_in_line.push_back (elt_idx_in_line);
+					idx_stack_bloc.push_back(bloc_idx_in_row);
+					values_stack.insert (values_stack.end (), values, values + NB_ROWS_PER_MULTILINE);
+				}
+				else
+				{
+					bloc_idx_in_row = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) / B.bloc_width();
+					elt_idx_in_line = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) % B.bloc_width();
+
+					B[row_bloc_idx][bloc_idx_in_row][line_idx_in_bloc].push_back (elt_idx_in_line, values);
+				}
+			}
+
+			//write into A (Right To Left)
+			for (int k = idx_stack_elt_idx_in_line.size() - 1; k >= 0; --k)
+				A[row_bloc_idx][idx_stack_bloc[k]][line_idx_in_bloc].push_back (idx_stack_elt_idx_in_line[k], &values_stack[k * NB_ROWS_PER_MULTILINE]);
+		}
+#else
 		uint32 i=0;
 		for(; i< ROUND_DOWN(nb_rows, 2); i+=2)	//A.bloc_height () must be even
 		{
@@ -590,12 +652,14 @@ public:
 				A[row_bloc_idx][idx_stack_bloc[k]][line_idx_in_bloc].ValuesData.push_back (v2_stack[k]);
 			}
 		}
+#endif
 
 		//Make hybrid multirows
 		if(!B.acceptRowsHybrid)
 			return;
 
 		MultiLineVector<Element, Index> tmp;
+		uint32 nb_sparse = 0, nb_dense = 0;
 
 		for(uint32 j=0; j<B[row_bloc_idx].size (); ++j)
 		{
@@ -604,8 +668,13 @@ public:
 				if(B[row_bloc_idx][j][k].empty ())
 					continue;
 
-				if((float)B[row_bloc_idx][j][k].size () / (float)B.bloc_width() < B.get_HYBRID_REPRESENTATION_THRESHOLD ())
+				if(HybridRepresentation::isSparse(B[row_bloc_idx][j][k].size (), B.bloc_width()))
+				{
+					++nb_sparse;
 					continue;
+				}
+
+				++nb_dense;
 
 				tmp.clear();
 				uint32 idx=0;
@@ -614,20 +683,22 @@ public:
 				{
 					if(idx < B[row_bloc_idx][j][k].size () && B[row_bloc_idx][j][k].IndexData[idx] == p)
 					{
-						tmp.ValuesData.push_back(B[row_bloc_idx][j][k].at_unchecked(0, idx));
-						tmp.ValuesData.push_back(B[row_bloc_idx][j][k].at_unchecked(1, idx));
+						for(uint16 l=0; l<NB_ROWS_PER_MULTILINE; ++l)
+							tmp.ValuesData.push_back(B[row_bloc_idx][j][k].at_unchecked(l, idx));
 						++idx;
 					}
 					else
 					{
-						tmp.ValuesData.push_back(0);
-						tmp.ValuesData.push_back(0);
+						for(uint16 l=0; l<NB_ROWS_PER_MULTILINE; ++l)
+							tmp.ValuesData.push_back(0);
 					}
 				}
 
 				B[row_bloc_idx][j][k].swap(tmp);
 			}
 		}
+
+		HybridRepresentation::count(nb_sparse, nb_dense);
 	}
 
 	/**
@@ -635,16 +706,17 @@ public:
 	 * In the case where the index maps are not yet constructed, the functions constructs the maps
 	 * implicitly; in that case, the matrices are re_initiliazed with the new corresponding dimentions
 	 */
-	void constructSubMatrices(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& C,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D,
+	template <typename SourceMatrix>
+	void constructSubMatrices(SourceMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool destruct_original_matrix)
 	{
 		//std::ostream &report = commentator.report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION);
 
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		if (!_index_maps_constructed)
 		{
@@ -797,14 +869,33 @@ public:
 
 	
 
-	void write_row_blocs_to_LeftMultiline_RightBloc_matrix(const SparseMatrix<Element>& M,
+	/// Second pass of the streaming mode: the rows of the bloc are read from the file right before being written
+	void write_row_blocs_to_LeftMultiline_RightBloc_matrix(const F4FileStream<Element>& M,
+			SparseMultilineMatrix<Element>& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 *rows_idxs,
+			uint32 nb_rows,
+			uint32 row_bloc_idx)
+	{
+		SparseMatrix<Element> rows (nb_rows, M.coldim ());
+		uint32 local_rows_idxs[nb_rows];
+
+		M.readRows (rows_idxs, nb_rows, rows);
+		for (uint32 j = 0; j < nb_rows; ++j)
+			local_rows_idxs[j] = j;
+
+		write_row_blocs_to_LeftMultiline_RightBloc_matrix(rows, A, B, local_rows_idxs, nb_rows, row_bloc_idx);
+	}
+
+	template <typename SourceMatrix>
+	void write_row_blocs_to_LeftMultiline_RightBloc_matrix(const SourceMatrix& M,
 							        SparseMultilineMatrix<Element>& A,
-								SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+								SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 								uint32 *rows_idxs,
 								uint32 nb_rows,
 								uint32 row_bloc_idx)
 	{
-		typename SparseVector<Element>::const_iterator it1, it2;
+		typename SourceMatrix::Row::const_iterator it1, it2;
 
 		B[row_bloc_idx].clear ();
 
@@ -824,6 +915,38 @@ public:
 		uint32 row_in_multiline_A;
 		
 		//2. write elements to blocs
+#if NB_ROWS_PER_MULTILINE != 2
+		typename SourceMatrix::Row::const_iterator its[NB_ROWS_PER_MULTILINE], its_end[NB_ROWS_PER_MULTILINE];
+		Element values[NB_ROWS_PER_MULTILINE];
+		uint32 col, nb_lines;
+
+		for(uint32 i=0; i<nb_rows; i+=NB_ROWS_PER_MULTILINE)
+		{
+			nb_lines = MIN(NB_ROWS_PER_MULTILINE, nb_rows - i);
+
+			for(uint32 l=0; l<nb_lines; ++l)
+			{
+				its[l] = M[rows_idxs[i+l]].begin ();
+				its_end[l] = M[rows_idxs[i+l]].end ();
+			}
+
+			line_idx_in_bloc = i/NB_ROWS_PER_MULTILINE;
+			row_in_multiline_A = row_bloc_idx * B.bloc_height () / NB_ROWS_PER_MULTILINE + line_idx_in_bloc;
+
+			while ((col = nextMultilineColumn(its, its_end, nb_lines, values)) != MINUS_ONE)
+			{
+				if(pivot_columns_map[col] != MINUS_ONE)		//pivot column
+					A[row_in_multiline_A].push_back (pivot_columns_map[col], values);
+				else
+				{
+					bloc_idx_in_row = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) / B.bloc_width();
+					elt_idx_in_line = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) % B.bloc_width();
+
+					B[row_bloc_idx][bloc_idx_in_row][line_idx_in_bloc].push_back (elt_idx_in_line, values);
+				}
+			}
+		}
+#else
 		uint32 i=0;
 		for(; i< ROUND_DOWN(nb_rows, 2); i+=2)	//A.bloc_height () must be even
 		{
@@ -998,18 +1121,20 @@ public:
 				++it1;
 			}
 		}
+#endif
 	}
 	
 	//C multiline
 
-	void constructSubMatrices(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	template <typename SourceMatrix>
+	void constructSubMatrices(SourceMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& C,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool destruct_original_matrix)
 	{
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		if (!_index_maps_constructed)
 		{
@@ -1141,14 +1266,15 @@ public:
 
 	//A and C multiline
 
-	void constructSubMatrices(SparseMatrix<Element>& M,
+	template <typename SourceMatrix>
+	void constructSubMatrices(SourceMatrix& M,
 			SparseMultilineMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& C,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool destruct_original_matrix)
 	{
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		if (!_index_maps_constructed)
 		{
@@ -1278,15 +1404,15 @@ public:
 
 	//inneficient computations
 
-	void constructSubMatrices(SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	void constructSubMatrices(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& D,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B1,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B2,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D1,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B1,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D1,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D2,
 			bool destruct_original_matrix)
 	{
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		B1 = Matrix(B.rowdim(), Npiv,
 				Matrix::ArrangementDownTop_RightLeft,
@@ -1356,7 +1482,7 @@ public:
 
 				bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
 
-				if(B[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+				if(B[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 				{
 					for (int p = 0; p<(int)B[blc_row_idx][j][row_idx_in_blc].size(); ++p)
 					{
@@ -1382,15 +1508,14 @@ public:
 
 				if(destruct_original_matrix)
 				{
-					if(vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] == 1)
+					if(vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 						B[blc_row_idx][j][row_idx_in_blc].free ();
 				}
 			}
 
 			if(destruct_original_matrix)
 			{
-				if(vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] == 0)
-					vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] = 1;
+				vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE]++;
 			}
 
 
@@ -1466,10 +1591,10 @@ public:
 
 			if(destruct_original_matrix)
 			{
-				if(vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE] == 0)
-					vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE] = 1;
-				else
+				if(vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 					rowD->free ();
+				else
+					vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE]++;
 			}
 
 			rows_idxs_horizontal_bloc[curr_vect_in_bloc] = curr_vect_in_bloc;
@@ -1614,10 +1739,10 @@ public:
 
 
 
-	void reconstructMatrix(SparseMatrix<Element>& M, SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	void reconstructMatrix(SparseMatrix<Element>& M, SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 									  SparseMultilineMatrix<Element>& D, bool free_matrices = false)
 	{
-		SparseBlocMatrix<SparseMultilineBloc<Element, Index> > _A_dummy;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > _A_dummy;
 		return reconstructMatrix(M, _A_dummy, B, D, free_matrices, true, false);
 	}
 
@@ -1625,8 +1750,8 @@ public:
 
 
 	void reconstructMatrix(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& D,
 			bool free_matrices = false,
 			bool A_is_null = false,
@@ -1702,15 +1827,10 @@ public:
 
 				if(free_matrices)
 				{
-					if(vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
-					else	//handled all the rows in the multiline, FREE now
-					{
-//						cout << "FREE ROW D" << endl;
+					if(vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)	//handled all the rows in the multiline, FREE now
 						rowD->free ();
-					}
+					else
+						vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE]++;	//mark it for deletion
 				}
 			}
 			else															//A & B
@@ -1727,7 +1847,7 @@ public:
 						/ NB_ROWS_PER_MULTILINE;
 
 				uint32 bloc_start_idx;
-				uint16 val;
+				Element val;
 				uint32 idx;
 
 				line = (B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i]) % NB_ROWS_PER_MULTILINE;
@@ -1744,7 +1864,7 @@ public:
 
 						bloc_start_idx = A.coldim() - 1 - A.FirstBlocsColumIndexes[blc_row_idx] - A.bloc_width() * j;
 
-						if(A[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+						if(A[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 						{
 							for (int p = A[blc_row_idx][j][row_idx_in_blc].size() - 1; p >= 0; --p)
 							{
@@ -1768,7 +1888,7 @@ public:
 
 						if(free_matrices)
 						{
-							if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
+							if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 							{
 								//cout << "FREE ROW A" << endl;
 								A[blc_row_idx][j][row_idx_in_blc].free ();
@@ -1791,7 +1911,7 @@ public:
 
 					bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
 
-					if(B[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+					if(B[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 					{
 						for (int p = 0; p<(int)B[blc_row_idx][j][row_idx_in_blc].size(); ++p)
 						{
@@ -1817,7 +1937,7 @@ public:
 
 					if(free_matrices)
 					{
-						if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
+						if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 						{
 							//cout << "FREE ROW B" << endl;
 							B[blc_row_idx][j][row_idx_in_blc].free ();
@@ -1827,10 +1947,7 @@ public:
 
 				if(free_matrices)
 				{
-					if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
+					vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE]++;	//mark it for deletion
 				}
 
 				row_M = &(M[piv]);
@@ -1858,7 +1975,7 @@ public:
 
 	void reconstructMatrix(SparseMatrix<Element>& M,
 			SparseMultilineMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& D,
 			bool free_matrices = false)
 	{
@@ -1926,14 +2043,10 @@ public:
 
 				if(free_matrices)
 				{
-					if(vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
-					else	//handled all the rows in the multiline, FREE now
-					{
+					if(vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)	//handled all the rows in the multiline, FREE now
 						rowD->free ();
-					}
+					else
+						vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE]++;	//mark it for deletion
 				}
 			}
 			else															//A & B
@@ -1950,7 +2063,7 @@ public:
 						/ NB_ROWS_PER_MULTILINE;
 
 				uint32 bloc_start_idx;
-				uint16 val;
+				Element val;
 				uint32 idx;
 
 
@@ -1992,7 +2105,7 @@ public:
 
 					bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
 
-					if(B[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+					if(B[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 					{
 						for (int p = 0; p<(int)B[blc_row_idx][j][row_idx_in_blc].size(); ++p)
 						{
@@ -2018,7 +2131,7 @@ public:
 
 					if(free_matrices)
 					{
-						if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
+						if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 						{
 							B[blc_row_idx][j][row_idx_in_blc].free ();
 						}
@@ -2027,10 +2140,7 @@ public:
 
 				if(free_matrices)
 				{
-					if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
+					vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE]++;	//mark it for deletion
 				}
 
 				row_M = &(M[piv]);
@@ -2059,18 +2169,18 @@ public:
 
 
 	void reconstructMatrix(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			bool free_matrices = false)
 	{
-		SparseBlocMatrix<SparseMultilineBloc<Element, Index> > _A_dummy;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > _A_dummy;
 		SparseMultilineMatrix<Element> _D_dummy;
 		return reconstructMatrix(M, _A_dummy, B, _D_dummy, free_matrices, true, true);
 	}
 
 
 	void reconstructMatrix(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B2,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D2,
 			bool free_matrices = false)
 	{
 
@@ -2116,7 +2226,7 @@ public:
 						/ NB_ROWS_PER_MULTILINE;
 
 				uint32 bloc_start_idx;
-				uint16 val;
+				Element val;
 				uint32 idx;
 
 				line = (D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv)) % NB_ROWS_PER_MULTILINE;
@@ -2134,7 +2244,7 @@ public:
 
 					bloc_start_idx = D2.FirstBlocsColumIndexes[blc_row_idx] + (D2.bloc_width() * j);
 
-					if(D2[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+					if(D2[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 					{
 						for (int p = 0; p<(int)D2[blc_row_idx][j][row_idx_in_blc].size(); ++p)
 						{
@@ -2156,15 +2266,14 @@ public:
 
 					if(free_matrices)
 					{
-						if(vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] == 1)
+						if(vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 							D2[blc_row_idx][j][row_idx_in_blc].free ();
 					}
 				}
 
 				if(free_matrices)
 				{
-					if(vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] == 0)
-						vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
+					vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE]++;	//mark it for deletion
 				}
 			}
 			else															//A & B
@@ -2181,7 +2290,7 @@ public:
 						/ NB_ROWS_PER_MULTILINE;
 
 				uint32 bloc_start_idx;
-				uint16 val;
+				Element val;
 				uint32 idx;
 
 				line = (B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i]) % NB_ROWS_PER_MULTILINE;
@@ -2201,7 +2310,7 @@ public:
 
 					bloc_start_idx = B2.FirstBlocsColumIndexes[blc_row_idx] + (B2.bloc_width() * j);
 
-					if(B2[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+					if(B2[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 					{
 						for (int p = 0; p<(int)B2[blc_row_idx][j][row_idx_in_blc].size(); ++p)
 						{
@@ -2225,7 +2334,7 @@ public:
 					{
 						if(free_matrices)
 						{
-							if(vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
+							if(vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 								B2[blc_row_idx][j][row_idx_in_blc].free ();
 						}
 					}
@@ -2233,8 +2342,7 @@ public:
 
 				if(free_matrices)
 				{
-					if(vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 0)
-						vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
+					vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE]++;	//mark it for deletion
 				}
 			}
 
@@ -2257,7 +2365,7 @@ public:
 
 	///Param only_rows is used to remap the new pivots only, no columns are considered;
 	///This is basically used when the echelon form is wanted, and not the RREF
-	void combineInnerIndexer(SequentialIndexer<Element, Index>& inner_idxr, bool only_rows = false)
+	void combineInnerIndexer(SequentialIndexer<Element, Index, BlocSize>& inner_idxr, bool only_rows = false)
 	{
 		uint32 i, idx_in_B, idx_in_B2, rev_idx_in_A;
 
@@ -10,37 +10,39 @@
 #define INDEXER_PARALLEL_H_
 
 #include "consts-macros.h"
+#include "f4-file-stream.h"
+#include "phase-profiler.h"
+#include "indexer-buffers.h"
+
+#include <vector>
 
 #include "lela/util/debug.h"
 #include "lela/util/commentator.h"
 
 using namespace LELA;
 
-template <typename Element, typename Index>
+template <typename Element, typename Index, uint16 BlocSize = DEFAULT_BLOC_SIZE>
 class ParallelIndexer
 {
 private:
 	void freeArrays()
 	{
-		if(pivot_columns_map != NULL)
-			delete [] pivot_columns_map;
-
-		if(non_pivot_columns_map != NULL)
-			delete [] non_pivot_columns_map;
-
-		if(pivot_columns_rev_map != NULL)
-			delete [] pivot_columns_rev_map;
-
-		if(non_pivot_columns_rev_map != NULL)
-			delete [] non_pivot_columns_rev_map;
+		IndexerBuffers::release(pivot_columns_map);
+		IndexerBuffers::release(non_pivot_columns_map);
+		IndexerBuffers::release(pivot_columns_rev_map);
+		IndexerBuffers::release(non_pivot_columns_rev_map);
+		IndexerBuffers::release(non_pivot_rows_idxs);
+		IndexerBuffers::release(pivot_rows_idxs_by_entry);
 
-		if(non_pivot_rows_idxs != NULL)
-			delete [] non_pivot_rows_idxs;
-
-		if(pivot_rows_idxs_by_entry != NULL)
-			delete [] pivot_rows_idxs_by_entry;
+		pivot_columns_map = NULL;
+		non_pivot_columns_map = NULL;
+		pivot_columns_rev_map = NULL;
+		non_pivot_columns_rev_map = NULL;
+		non_pivot_rows_idxs = NULL;
+		pivot_rows_idxs_by_entry = NULL;
 	}
 
+	/// The arrays come from IndexerBuffers, so the indexers of successive matrices share them
 	void initArrays(uint32 rowSize, uint32 colSize)
 	{
 		if(colSize == 0)
@@ -51,25 +53,98 @@ private:
 
 		freeArrays();
 
-		pivot_columns_map = new uint32 [colSize];
+		pivot_columns_map = IndexerBuffers::acquire(colSize);
 		memset(pivot_columns_map, MINUS_ONE_8, colSize * sizeof(uint32));
 
-		non_pivot_columns_map = new uint32 [colSize];
+		non_pivot_columns_map = IndexerBuffers::acquire(colSize);
 		memset(non_pivot_columns_map, MINUS_ONE_8, colSize * sizeof(uint32));
 
-		pivot_columns_rev_map = new uint32 [colSize];
+		pivot_columns_rev_map = IndexerBuffers::acquire(colSize);
 		memset(pivot_columns_rev_map, MINUS_ONE_8, colSize * sizeof(uint32));
 
-		non_pivot_columns_rev_map = new uint32 [colSize];
+		non_pivot_columns_rev_map = IndexerBuffers::acquire(colSize);
 		memset(non_pivot_columns_rev_map, MINUS_ONE_8, colSize * sizeof(uint32));
 
-		pivot_rows_idxs_by_entry = new uint32 [colSize];
+		pivot_rows_idxs_by_entry = IndexerBuffers::acquire(colSize);
 		memset(pivot_rows_idxs_by_entry, MINUS_ONE_8, colSize * sizeof(uint32));
 
-		non_pivot_rows_idxs = new uint32 [rowSize];
+		non_pivot_rows_idxs = IndexerBuffers::acquire(rowSize);
 		memset(non_pivot_rows_idxs, MINUS_ONE_8, rowSize * sizeof(uint32));
 	}
 
+	/// Lowers key_slot to key if key is smaller, against the other threads
+	static inline void electPivot(uint64& key_slot, uint64 key)
+	{
+		uint64 old = key_slot;
+
+		while(key < old && !__sync_bool_compare_and_swap(&key_slot, old, key))
+			old = key_slot;
+	}
+
+	/**
+	 * Sets the pivot row of each column from the key elected for it (the row index is in its low
+	 * 32 bits, (uint64) -1 for no pivot), numbers the pivot and the non pivot columns in order and
+	 * sets Npiv: each thread counts the pivots of a range of columns, and numbers its range
+	 * starting from the counts of the ranges before it
+	 */
+	void buildColumnMaps(const std::vector<uint64>& pivot_keys)
+	{
+		const uint32 nb_ranges = MAX(NB_THREADS, 1);
+		const uint32 range_size = (this->coldim + nb_ranges - 1) / nb_ranges;
+		std::vector<uint32> nb_pivots_before (nb_ranges + 1, 0);
+
+omp_set_dynamic(0);
+#pragma omp parallel num_threads(NB_THREADS)
+		{
+#pragma omp for schedule(static, 1)
+			for (uint32 r = 0; r < nb_ranges; ++r)
+			{
+				const uint32 begin = MIN(r * range_size, this->coldim);
+				const uint32 end = MIN(begin + range_size, this->coldim);
+
+				for (uint32 i = begin; i < end; ++i)
+				{
+					if(pivot_keys[i] != (uint64) -1)
+					{
+						pivot_rows_idxs_by_entry[i] = (uint32) pivot_keys[i];
+						++nb_pivots_before[r + 1];
+					}
+				}
+			}
+
+#pragma omp single
+			for (uint32 r = 0; r < nb_ranges; ++r)
+				nb_pivots_before[r + 1] += nb_pivots_before[r];
+
+#pragma omp for schedule(static, 1)
+			for (uint32 r = 0; r < nb_ranges; ++r)
+			{
+				const uint32 begin = MIN(r * range_size, this->coldim);
+				const uint32 end = MIN(begin + range_size, this->coldim);
+				uint32 piv_col_idx = nb_pivots_before[r];
+				uint32 non_piv_col_idx = begin - piv_col_idx;
+
+				for (uint32 i = begin; i < end; ++i)
+				{
+					if(pivot_rows_idxs_by_entry[i] != MINUS_ONE)
+					{
+						pivot_columns_map[i] = piv_col_idx;
+						pivot_columns_rev_map[piv_col_idx] = i;
+						piv_col_idx++;
+					}
+					else
+					{
+						non_pivot_columns_map[i] = non_piv_col_idx;
+						non_pivot_columns_rev_map[non_piv_col_idx] = i;
+						non_piv_col_idx++;
+					}
+				}
+			}
+		}
+
+		Npiv = nb_pivots_before[nb_ranges];
+	}
+
 	static const uint32 MINUS_ONE = (uint32)-1 ;
 	static const uint8 MINUS_ONE_8 = (uint8)-1;
 
@@ -145,118 +220,56 @@ public:
 
 	void freeMemory()
 	{
-		if(pivot_columns_map != NULL)
-		{
-			delete [] pivot_columns_map;
-			pivot_columns_map = NULL;
-		}
-
-		if(non_pivot_columns_map != NULL)
-		{
-			delete [] non_pivot_columns_map;
-			non_pivot_columns_map = NULL;
-		}
-
-		if(pivot_columns_rev_map != NULL)
-		{
-			delete [] pivot_columns_rev_map;
-			pivot_columns_rev_map = NULL;
-		}
-
-		if(non_pivot_columns_rev_map != NULL)
-		{
-			delete [] non_pivot_columns_rev_map;
-			non_pivot_columns_rev_map = NULL;
-		}
-
-		if(non_pivot_rows_idxs != NULL)
-		{
-			delete [] non_pivot_rows_idxs;
-			non_pivot_rows_idxs = NULL;
-		}
-
-		if(pivot_rows_idxs_by_entry != NULL)
-		{
-			delete [] pivot_rows_idxs_by_entry;
-			pivot_rows_idxs_by_entry = NULL;
-		}
+		freeArrays();
 	}
 
 	/**
 	 * Constructs the maps of indexes of the original matrix.
 	 * Identifies the list of pivot/non pivot rows, pivot/non pivot columns and their reverse maps
 	 * (reverse map is the correspondance from indexes in sub matrices to the original matrix)
+	 * SourceMatrix is a SparseMatrix<Element> or an F4MatrixView<Element> (matrix file mapped in memory)
 	 */
-	void processMatrix(const SparseMatrix<Element>& M)
+	template <typename SourceMatrix>
+	void processMatrix(const SourceMatrix& M)
 	{
 		this->coldim = M.coldim ();
 		this->rowdim = M.rowdim ();
 
-		typename SparseMatrix<Element>::ConstRowIterator i_M;
-		uint32 curr_row_idx = 0, entry;
-
 		initArrays(this->rowdim, this->coldim);
 
-		Npiv = 0;
+		//the pivot of a column is the shortest row starting on it, the first one of the shortest
+		//(ELGAB Sylvain): the smallest (size, row index), which the threads elect with atomics
+		std::vector<uint64> pivot_keys (this->coldim, (uint64) -1);
+		std::vector<uint32> heads (this->rowdim);
 
-		//Sweeps the rows to identify the row pivots and column pivots
-		for (i_M = M.rowBegin (); i_M != M.rowEnd (); ++i_M)
+omp_set_dynamic(0);
+#pragma omp parallel num_threads(NB_THREADS)
 		{
-			if(!i_M->empty ())
+#pragma omp for schedule(static, INDEXER_ROWS_PER_TASK)
+			for (uint32 i = 0; i < this->rowdim; ++i)
 			{
-				entry = i_M->front ().first;
-				if(pivot_rows_idxs_by_entry[entry] == MINUS_ONE)
-				{
-					pivot_rows_idxs_by_entry[entry] = curr_row_idx;
-					Npiv++;
-				}
-				else	//choose the least sparse row //ELGAB Sylvain
+				typename SourceMatrix::ConstRow& row = M[i];
+
+				if(row.empty ())
 				{
-					//check if the pivot is less dense. replace it with this one
-					if(M[pivot_rows_idxs_by_entry[entry]].size () > i_M->size ())
-					{
-						non_pivot_rows_idxs[pivot_rows_idxs_by_entry[entry]] = pivot_rows_idxs_by_entry[entry];
-						pivot_rows_idxs_by_entry[entry] = curr_row_idx;
-					}
-					else
-						non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
+					heads[i] = MINUS_ONE;
+					continue;
 				}
-			}
-			else
-				non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-
-			++curr_row_idx;
-		}
-
-		//construct the column pivots (non column pivots) map and its reverse map
-		uint32 piv_col_idx = 0, non_piv_col_idx = 0;
-		for(uint32 i = 0; i < this->coldim; ++i){
-			if(pivot_rows_idxs_by_entry[i] != MINUS_ONE)
-			{
-				pivot_columns_map[i] = piv_col_idx;
-				pivot_columns_rev_map[piv_col_idx] = i;
 
-				piv_col_idx++;
+				heads[i] = row.front ().first;
+				electPivot(pivot_keys[heads[i]], ((uint64) row.size () << 32) | i);
 			}
-			else
-			{
-				non_pivot_columns_map[i] = non_piv_col_idx;
-				non_pivot_columns_rev_map[non_piv_col_idx] = i;
 
-				non_piv_col_idx++;
+			//the rows that lost are the non pivot rows, with the empty ones
+#pragma omp for schedule(static, INDEXER_ROWS_PER_TASK)
+			for (uint32 i = 0; i < this->rowdim; ++i)
+			{
+				if(heads[i] == MINUS_ONE || (uint32) pivot_keys[heads[i]] != i)
+					non_pivot_rows_idxs[i] = i;
 			}
 		}
 
-		/*lela_check(Npiv == piv_col_idx);
-		lela_check(this->coldim - Npiv == non_piv_col_idx);
-
-		for(uint32 i = 0; i < this->coldim; ++i){
-			lela_check((pivot_columns_map[i] < Npiv) || (pivot_columns_map[i] == MINUS_ONE));
-		}
-
-		for(uint32 i = 0; i < this->coldim; ++i){
-			lela_check((non_pivot_columns_map[i] < (this->coldim - Npiv))  || (non_pivot_columns_map[i] == MINUS_ONE));
-		}*/
+		buildColumnMaps(pivot_keys);
 
 		_index_maps_constructed = true;
 	}
@@ -266,129 +279,113 @@ public:
 		this->coldim = M.coldim ();
 		this->rowdim = M.rowdim ();
 
-		typename SparseMultilineMatrix<Element>::ConstRowIterator i_M;
-		uint32 curr_row_idx = 0;
-		long h1, h2;
-		uint32 h1_idx, h2_idx;
-		Element h1_val, h2_val;
+		const uint32 nb_multilines = M.rowEnd () - M.rowBegin ();
 
-		//In case there is a null line at the end of a multiline
-		initArrays(this->rowdim + this->rowdim % M.nb_lines_per_bloc (), this->coldim);
+		//In case there are null lines at the end of the last multiline
+		initArrays(M.multiline_rowdim () * M.nb_lines_per_bloc (), this->coldim);
 
-		Npiv = 0;
+		//the pivot of a column is the first row starting on it
+		//TODO New choose the least sparse row //ELGAB Sylvain
+		std::vector<uint64> pivot_keys (this->coldim, (uint64) -1);
+		std::vector<uint32> heads (NB_ROWS_PER_MULTILINE * nb_multilines);
 
-		//Sweeps the rows to identify the row pivots and column pivots
-		for (i_M = M.rowBegin (); i_M != M.rowEnd (); ++i_M)
+omp_set_dynamic(0);
+#pragma omp parallel num_threads(NB_THREADS)
 		{
-			if(!i_M->empty ())
+#pragma omp for schedule(static, INDEXER_ROWS_PER_TASK / NB_ROWS_PER_MULTILINE)
+			for (uint32 m = 0; m < nb_multilines; ++m)
 			{
-				h1 = Level1Ops::headMultiLineVectorHybrid(*i_M, 0, h1_val, h1_idx, M.coldim());
-				h2 = Level1Ops::headMultiLineVectorHybrid(*i_M, 1, h2_val, h2_idx, M.coldim());
+				const typename SparseMultilineMatrix<Element>::Row& row = M[m];
+				uint32 h_idx;
+				Element h_val;
 
-				//LINE 1
-				if(h1 == -1)	//empty line
+				for (uint32 l = 0; l < NB_ROWS_PER_MULTILINE; ++l)
 				{
-					non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-				}
-				else
-				{
-					if(pivot_rows_idxs_by_entry[h1] == MINUS_ONE)		//non empty
-					{
-						pivot_rows_idxs_by_entry[h1] = curr_row_idx;
-						Npiv++;
-					}
-					else		//TODO New choose the least sparse row //ELGAB Sylvain
-					{
-						//check if the pivot is less dense. replace it with this one
-						/*if(M[pivot_rows_idxs_by_entry[h1]].size () > i_M->size ())
-						{
-							non_pivot_rows_idxs[pivot_rows_idxs_by_entry[h1]] = pivot_rows_idxs_by_entry[h1];
-							pivot_rows_idxs_by_entry[h1] = curr_row_idx;
-							//Npiv++;
-						}
-						else*/
-						non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-					}
-				}
+					const long h = row.empty () ? -1 : Level1Ops::headMultiLineVectorHybrid(row, l, h_val, h_idx, M.coldim());
 
-				++curr_row_idx;
-				//LINE 2
-				if(h2 == -1)	//empty line
-				{
-					non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-				}
-				else
-				{
-					if(pivot_rows_idxs_by_entry[h2] == MINUS_ONE)
-					{
-						pivot_rows_idxs_by_entry[h2] = curr_row_idx;
-						Npiv++;
-					}
-					else		//TODO New choose the least sparse row //ELGAB Sylvain
-					{
-						//check if the pivot is less dense. replace it with this one
-						/*if(M[pivot_rows_idxs_by_entry[h2]].size () > i_M->size ())
-						{
-							non_pivot_rows_idxs[pivot_rows_idxs_by_entry[h2]] = pivot_rows_idxs_by_entry[h2];
-							pivot_rows_idxs_by_entry[h2] = curr_row_idx;
-							//Npiv++;
-						}
-						else*/
-						non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-					}
+					heads[NB_ROWS_PER_MULTILINE * m + l] = h == -1 ? MINUS_ONE : (uint32) h;
+					if(h != -1)
+						electPivot(pivot_keys[h], NB_ROWS_PER_MULTILINE * m + l);
 				}
-
-				++curr_row_idx;
-			}
-			else		//multiline is empty
-			{
-				non_pivot_rows_idxs[curr_row_idx] = curr_row_idx;
-				non_pivot_rows_idxs[curr_row_idx+1] = curr_row_idx+1;
-				curr_row_idx += 2;
 			}
-		}
 
-		//construct the column pivots (non column pivots) map and its reverse
-		uint32 piv_col_idx = 0, non_piv_col_idx = 0;
-		for(uint32 i = 0; i < this->coldim; ++i){
-			if(pivot_rows_idxs_by_entry[i] != MINUS_ONE)
-			{
-				pivot_columns_map[i] = piv_col_idx;
-				pivot_columns_rev_map[piv_col_idx] = i;
-				piv_col_idx++;
-			}
-			else
+#pragma omp for schedule(static, INDEXER_ROWS_PER_TASK)
+			for (uint32 i = 0; i < NB_ROWS_PER_MULTILINE * nb_multilines; ++i)
 			{
-				non_pivot_columns_map[i] = non_piv_col_idx;
-				non_pivot_columns_rev_map[non_piv_col_idx] = i;
-				non_piv_col_idx++;
+				if(heads[i] == MINUS_ONE || (uint32) pivot_keys[heads[i]] != i)
+					non_pivot_rows_idxs[i] = i;
 			}
 		}
 
-//		assert(Npiv == piv_col_idx);
-//		assert(this->coldim - Npiv == non_piv_col_idx);
-//
-//		for(uint32 i = 0; i < this->coldim; ++i){
-//			assert((pivot_columns_map[i] < Npiv) || (pivot_columns_map[i] == MINUS_ONE));
-//		}
-//
-//		for(uint32 i = 0; i < this->coldim; ++i){
-//			assert((non_pivot_columns_map[i] < (this->coldim - Npiv))  || (non_pivot_columns_map[i] == MINUS_ONE));
-//		}
+		buildColumnMaps(pivot_keys);
 
 		_index_maps_constructed = true;
 	}
 
 
 
-	void write_row_blocs_to_Left_Right_matrix(const SparseMatrix<Element>& M,
-												SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-												SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	/// Second pass of the streaming mode: the rows of the bloc are read from the file right before being written
+	void write_row_blocs_to_Left_Right_matrix(const F4FileStream<Element>& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 *rows_idxs,
+			uint32 nb_rows,
+			uint32 row_bloc_idx)
+	{
+		SparseMatrix<Element> rows (nb_rows, M.coldim ());
+		uint32 local_rows_idxs[nb_rows];
+
+		M.readRows (rows_idxs, nb_rows, rows);
+		for (uint32 j = 0; j < nb_rows; ++j)
+			local_rows_idxs[j] = j;
+
+		write_row_blocs_to_Left_Right_matrix(rows, A, B, local_rows_idxs, nb_rows, row_bloc_idx);
+	}
+
+	/// Returns the smallest column over the iterators of the nb_lines rows of a multiline, MINUS_ONE
+	/// when all the rows are read; values gets the entry of each line at that column (0 if none)
+	/// and the iterators sitting on it are advanced
+	template <typename Iterator>
+	static inline uint32 nextMultilineColumn(Iterator *its, const Iterator *its_end, uint32 nb_lines, Element *values)
+	{
+		uint32 col = MINUS_ONE;
+
+		for (uint32 l = 0; l < nb_lines; ++l)
+			if (its[l] != its_end[l] && its[l]->first < col)
+				col = its[l]->first;
+
+		if (col == MINUS_ONE)
+			return MINUS_ONE;
+
+		for (uint32 l = 0; l < NB_ROWS_PER_MULTILINE; ++l)
+		{
+			if (l < nb_lines && its[l] != its_end[l] && its[l]->first == col)
+			{
+				values[l] = its[l]->second;
+				++its[l];
+			}
+			else
+				values[l] = 0;
+		}
+
+		return col;
+	}
+
+	template <typename SourceMatrix>
+	void write_row_blocs_to_Left_Right_matrix(const SourceMatrix& M,
+												SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+												SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 												uint32 *rows_idxs,
 												uint32 nb_rows,
 												uint32 row_bloc_idx)
 	{
-		typename SparseVector<Element>::const_iterator it1, it2;
+		typename SourceMatrix::Row::const_iterator it1, it2;
+		PhaseProfiler::Scope profile (PhaseProfiler::INDEXER);
+		uint64 nb_entries = 0;
+
+		for (uint32 i = 0; i < nb_rows; ++i)
+			nb_entries += M[rows_idxs[i]].size ();
+		PhaseProfiler::count (0, nb_entries * (sizeof (Element) + sizeof (uint32)), 1);
 
 		A[row_bloc_idx].clear ();
 		B[row_bloc_idx].clear ();
@@ -418,6 +415,53 @@ public:
 			B[row_bloc_idx][k].init(B.bloc_height (), B.bloc_width ());
 
 		//2. write elements to blocs
+#if NB_ROWS_PER_MULTILINE != 2
+		typename SourceMatrix::Row::const_iterator its[NB_ROWS_PER_MULTILINE], its_end[NB_ROWS_PER_MULTILINE];
+		Element values[NB_ROWS_PER_MULTILINE];
+		std::vector<Element> values_stack;
+		uint32 col, nb_lines;
+
+		for(uint32 i=0; i<nb_rows; i+=NB_ROWS_PER_MULTILINE)
+		{
+			nb_lines = MIN(NB_ROWS_PER_MULTILINE, nb_rows - i);
+
+			for(uint32 l=0; l<nb_lines; ++l)
+			{
+				its[l] = M[rows_idxs[i+l]].begin ();
+				its_end[l] = M[rows_idxs[i+l]].end ();
+			}
+
+			idx_stack_elt_idx_in_line.clear();
+			idx_stack_bloc.clear();
+			values_stack.clear();
+
+			line_idx_in_bloc = i/NB_ROWS_PER_MULTILINE;
+
+			while ((col = nextMultilineColumn(its, its_end, nb_lines, values)) != MINUS_ONE)
+			{
+				if(pivot_columns_map[col] != MINUS_ONE)		//pivot column
+				{
+					bloc_idx_in_row = (A.coldim () - 1 - pivot_columns_map[col] - A.FirstBlocsColumIndexes[row_bloc_idx]) / A.bloc_width();
+					elt_idx_in_line = (A.coldim () - 1 - pivot_columns_map[col] - A.FirstBlocsColumIndexes[row_bloc_idx]) % A.bloc_width();
+
+					idx_stack_elt_idx_in_line.push_back (elt_idx_in_line);
+					idx_stack_bloc.push_back(bloc_idx_in_row);
+					values_stack.insert (values_stack.end (), values, values + NB_ROWS_PER_MULTILINE);
+				}
+				else
+				{
+					bloc_idx_in_row = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) / B.bloc_width();
+					elt_idx_in_line = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) % B.bloc_width();
+
+					B[row_bloc_idx][bloc_idx_in_row][line_idx_in_bloc].push_back (elt_idx_in_line, values);
+				}
+			}
+
+			//write into A (Right To Left)
+			for (int k = idx_stack_elt_idx_in_line.size() - 1; k >= 0; --k)
+				A[row_bloc_idx][idx_stack_bloc[k]][line_idx_in_bloc].push_back (idx_stack_elt_idx_in_line[k], &values_stack[k * NB_ROWS_PER_MULTILINE]);
+		}
+#else
 		uint32 i=0;
 		for(; i< ROUND_DOWN(nb_rows, 2); i+=2)	//A.bloc_height () must be even
 		{
@@ -611,12 +655,14 @@ public:
 				A[row_bloc_idx][idx_stack_bloc[k]][line_idx_in_bloc].ValuesData.push_back (v2_stack[k]);
 			}
 		}
+#endif
 
 		//Make hybrid multirows
 		if(!B.acceptRowsHybrid)
 			return;
 
 		MultiLineVector<Element, Index> tmp;
+		uint32 nb_sparse = 0, nb_dense = 0;
 
 		for(uint32 j=0; j<B[row_bloc_idx].size (); ++j)
 		{
@@ -625,8 +671,13 @@ public:
 				if(B[row_bloc_idx][j][k].empty ())
 					continue;
 
-				if((float)B[row_bloc_idx][j][k].size () / (float)B.bloc_width() < B.get_HYBRID_REPRESENTATION_THRESHOLD ())
+				if(HybridRepresentation::isSparse(B[row_bloc_idx][j][k].size (), B.bloc_width()))
+				{
+					++nb_sparse;
 					continue;
+				}
+
+				++nb_dense;
 
 				tmp.clear();
 				uint32 idx=0;
@@ -635,20 +686,22 @@ public:
 				{
 					if(idx < B[row_bloc_idx][j][k].size () && B[row_bloc_idx][j][k].IndexData[idx] == p)
 					{
-						tmp.ValuesData.push_back(B[row_bloc_idx][j][k].at_unchecked(0, idx));
-						tmp.ValuesData.push_back(B[row_bloc_idx][j][k].at_unchecked(1, idx));
+						for(uint16 l=0; l<NB_ROWS_PER_MULTILINE; ++l)
+							tmp.ValuesData.push_back(B[row_bloc_idx][j][k].at_unchecked(l, idx));
 						++idx;
 					}
 					else
 					{
-						tmp.ValuesData.push_back(0);
-						tmp.ValuesData.push_back(0);
+						for(uint16 l=0; l<NB_ROWS_PER_MULTILINE; ++l)
+							tmp.ValuesData.push_back(0);
 					}
 				}
 
 				B[row_bloc_idx][j][k].swap(tmp);
 			}
 		}
+
+		HybridRepresentation::count(nb_sparse, nb_dense);
 	}
 
 	/**
@@ -657,16 +710,17 @@ public:
 	 * implicitly; in that case, the matrices are re_initiliazed with the new corresponding dimentions
 	 */
 
-	void constructSubMatrices(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& C,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D,
+	template <typename SourceMatrix>
+	void constructSubMatrices(SourceMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool destruct_original_matrix)
 	{
 		//std::ostream &report = commentator.report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION);
 
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		if (!_index_maps_constructed)
 		{
@@ -827,14 +881,39 @@ omp_set_dynamic(0);
 
 	
 
-	void write_row_blocs_to_LeftMultiline_RightBloc_matrix(const SparseMatrix<Element>& M,
+	/// Second pass of the streaming mode: the rows of the bloc are read from the file right before being written
+	void write_row_blocs_to_LeftMultiline_RightBloc_matrix(const F4FileStream<Element>& M,
+			SparseMultilineMatrix<Element>& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 *rows_idxs,
+			uint32 nb_rows,
+			uint32 row_bloc_idx)
+	{
+		SparseMatrix<Element> rows (nb_rows, M.coldim ());
+		uint32 local_rows_idxs[nb_rows];
+
+		M.readRows (rows_idxs, nb_rows, rows);
+		for (uint32 j = 0; j < nb_rows; ++j)
+			local_rows_idxs[j] = j;
+
+		write_row_blocs_to_LeftMultiline_RightBloc_matrix(rows, A, B, local_rows_idxs, nb_rows, row_bloc_idx);
+	}
+
+	template <typename SourceMatrix>
+	void write_row_blocs_to_LeftMultiline_RightBloc_matrix(const SourceMatrix& M,
 							        SparseMultilineMatrix<Element>& A,
-								SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+								SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 								uint32 *rows_idxs,
 								uint32 nb_rows,
 								uint32 row_bloc_idx)
 	{
-		typename SparseVector<Element>::const_iterator it1, it2;
+		typename SourceMatrix::Row::const_iterator it1, it2;
+		PhaseProfiler::Scope profile (PhaseProfiler::INDEXER);
+		uint64 nb_entries = 0;
+
+		for (uint32 i = 0; i < nb_rows; ++i)
+			nb_entries += M[rows_idxs[i]].size ();
+		PhaseProfiler::count (0, nb_entries * (sizeof (Element) + sizeof (uint32)), 1);
 
 		B[row_bloc_idx].clear ();
 
@@ -854,6 +933,38 @@ omp_set_dynamic(0);
 		uint32 row_in_multiline_A;
 		
 		//2. write elements to blocs
+#if NB_ROWS_PER_MULTILINE != 2
+		typename SourceMatrix::Row::const_iterator its[NB_ROWS_PER_MULTILINE], its_end[NB_ROWS_PER_MULTILINE];
+		Element values[NB_ROWS_PER_MULTILINE];
+		uint32 col, nb_lines;
+
+		for(uint32 i=0; i<nb_rows; i+=NB_ROWS_PER_MULTILINE)
+		{
+			nb_lines = MIN(NB_ROWS_PER_MULTILINE, nb_rows - i);
+
+			for(uint32 l=0; l<nb_lines; ++l)
+			{
+				its[l] = M[rows_idxs[i+l]].begin ();
+				its_end[l] = M[rows_idxs[i+l]].end ();
+			}
+
+			line_idx_in_bloc = i/NB_ROWS_PER_MULTILINE;
+			row_in_multiline_A = row_bloc_idx * B.bloc_height () / NB_ROWS_PER_MULTILINE + line_idx_in_bloc;
+
+			while ((col = nextMultilineColumn(its, its_end, nb_lines, values)) != MINUS_ONE)
+			{
+				if(pivot_columns_map[col] != MINUS_ONE)		//pivot column
+					A[row_in_multiline_A].push_back (pivot_columns_map[col], values);
+				else
+				{
+					bloc_idx_in_row = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) / B.bloc_width();
+					elt_idx_in_line = (non_pivot_columns_map[col] - B.FirstBlocsColumIndexes[row_bloc_idx]) % B.bloc_width();
+
+					B[row_bloc_idx][bloc_idx_in_row][line_idx_in_bloc].push_back (elt_idx_in_line, values);
+				}
+			}
+		}
+#else
 		uint32 i=0;
 		for(; i< ROUND_DOWN(nb_rows, 2); i+=2)	//A.bloc_height () must be even
 		{
@@ -1028,18 +1139,20 @@ omp_set_dynamic(0);
 				++it1;
 			}
 		}
+#endif
 	}
 	
 	//C multiline
 
-	void constructSubMatrices(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	template <typename SourceMatrix>
+	void constructSubMatrices(SourceMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& C,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool destruct_original_matrix)
 	{
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		if (!_index_maps_constructed)
 		{
@@ -1198,14 +1311,15 @@ omp_set_dynamic(0);
 
 	//A and C multiline
 
-	void constructSubMatrices(SparseMatrix<Element>& M,
+	template <typename SourceMatrix>
+	void constructSubMatrices(SourceMatrix& M,
 			SparseMultilineMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& C,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool destruct_original_matrix)
 	{
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		if (!_index_maps_constructed)
 		{
@@ -1365,15 +1479,15 @@ omp_set_dynamic(0);
 
 	//inneficient computations
 
-	void constructSubMatrices(SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	void constructSubMatrices(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& D,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B1,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B2,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D1,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B1,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D1,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D2,
 			bool destruct_original_matrix)
 	{
-		typedef SparseBlocMatrix<SparseMultilineBloc<uint16, Index> > Matrix;
+		typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > Matrix;
 
 		B1 = Matrix(B.rowdim(), Npiv,
 				Matrix::ArrangementDownTop_RightLeft,
@@ -1443,7 +1557,7 @@ omp_set_dynamic(0);
 
 				bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
 
-				if(B[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+				if(B[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 				{
 					for (int p = 0; p<(int)B[blc_row_idx][j][row_idx_in_blc].size(); ++p)
 					{
@@ -1469,15 +1583,15 @@ omp_set_dynamic(0);
 
 				if(destruct_original_matrix)
 				{
-					if(vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] == 1)
+					if(vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 						B[blc_row_idx][j][row_idx_in_blc].free ();
 				}
 			}
 
 			if(destruct_original_matrix)
 			{
-				if(vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] == 0)
-					vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE] = 1;
+				//counts the lines of the multiline already copied, it is freed with the last one
+				vectors_to_free_B[(B.rowdim() - 1 - i)/ NB_ROWS_PER_MULTILINE]++;
 			}
 
 
@@ -1553,10 +1667,10 @@ omp_set_dynamic(0);
 
 			if(destruct_original_matrix)
 			{
-				if(vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE] == 0)
-					vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE] = 1;
-				else
+				if(vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE] == NB_ROWS_PER_MULTILINE - 1)
 					rowD->free ();
+				else
+					vectors_to_free_D[pivot_rows_idxs_by_entry[i]/NB_ROWS_PER_MULTILINE]++;
 			}
 
 			rows_idxs_horizontal_bloc[curr_vect_in_bloc] = curr_vect_in_bloc;
@@ -1701,19 +1815,166 @@ omp_set_dynamic(0);
 
 
 
-	void reconstructMatrix(SparseMatrix<Element>& M, SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
-									  SparseMultilineMatrix<Element>& D, bool free_matrices = false)
+	/// Number of the non zero values of line in the row row_idx_in_blc of the bloc row blc_row_idx of B
+	uint32 countBlocLine(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 blc_row_idx, uint32 row_idx_in_blc, uint16 line)
 	{
-		SparseBlocMatrix<SparseMultilineBloc<Element, Index> > _A_dummy;
-		return reconstructMatrix(M, _A_dummy, B, D, free_matrices, true, false);
+		uint32 nb = 0;
+
+		for(uint32 j=0; j<B[blc_row_idx].size (); ++j)
+		{
+			if(B[blc_row_idx][j].empty () || B[blc_row_idx][j][row_idx_in_blc].empty ())
+				continue;
+
+			const typename SparseMultilineBloc<Element, Index, BlocSize>::Row& row = B[blc_row_idx][j][row_idx_in_blc];
+			const uint32 sz = row.is_sparse (BlocSize) ? row.size () : B.bloc_width ();
+
+			for(uint32 p=0; p<sz; ++p)
+				if(row.at_unchecked(line, p) != 0)
+					++nb;
+		}
+
+		return nb;
+	}
+
+	/**
+	 * Appends to rowM the entries of left (indexes of the columns of A, in order) merged with the
+	 * non zero values of line in the row row_idx_in_blc of the bloc row blc_row_idx of B, both mapped
+	 * back to the columns of the original matrix. rowM is sized for all of them first, and the
+	 * values of B are written to it directly rather than through a temporary row
+	 */
+	template <typename SparseRow>
+	void push_rowsAB_to_rowM(const SparseVector<Element>& left,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 blc_row_idx, uint32 row_idx_in_blc, uint16 line, SparseRow& rowM)
+	{
+		typename SparseVector<Element>::const_iterator it = left.begin ();
+		uint32 bloc_start_idx, col;
+		Element val;
+
+		rowM.reserve (rowM.size () + left.size () + countBlocLine(B, blc_row_idx, row_idx_in_blc, line));
+
+		for(uint32 j=0; j<B[blc_row_idx].size (); ++j)
+		{
+			if(B[blc_row_idx][j].empty () || B[blc_row_idx][j][row_idx_in_blc].empty ())
+				continue;
+
+			const typename SparseMultilineBloc<Element, Index, BlocSize>::Row& row = B[blc_row_idx][j][row_idx_in_blc];
+			const bool sparse = row.is_sparse (BlocSize);
+			const uint32 sz = sparse ? row.size () : B.bloc_width ();
+
+			bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
+
+			for(uint32 p=0; p<sz; ++p)
+			{
+				val = row.at_unchecked(line, p);
+
+				if(val == 0)
+					continue;
+
+				col = non_pivot_columns_rev_map[bloc_start_idx + (sparse ? row.IndexData[p] : p)];
+
+				for(; it != left.end () && pivot_columns_rev_map[it->first] < col; ++it)
+					rowM.push_back (typename SparseRow::value_type(pivot_columns_rev_map[it->first], it->second));
+
+				rowM.push_back (typename SparseRow::value_type(col, val));
+			}
+		}
+
+		for(; it != left.end (); ++it)
+			rowM.push_back (typename SparseRow::value_type(pivot_columns_rev_map[it->first], it->second));
+	}
+
+	/// Appends to rowM the non zero values of line of the multiline rowD of D, mapped back to the
+	/// columns of the original matrix, sizing rowM for them first
+	template <typename SparseRow>
+	void push_rowD_to_rowM(const typename SparseMultilineMatrix<Element>::Row& rowD, const uint16 line,
+			uint32 coldim_D, SparseRow& rowM)
+	{
+		const bool sparse = rowD.is_sparse (coldim_D);
+		const uint32 sz = sparse ? rowD.size () : coldim_D;
+		uint32 nb = 0;
+		Element val;
+
+		for(uint32 j=0; j<sz; ++j)
+			if(rowD.at_unchecked(line, j) != 0)
+				++nb;
+
+		rowM.reserve (rowM.size () + nb);
+
+		for(uint32 j=0; j<sz; ++j)
+		{
+			val = rowD.at_unchecked(line, j);
+
+			if(val != 0)
+				rowM.push_back (typename SparseRow::value_type(
+									non_pivot_columns_rev_map[sparse ? rowD.IndexData[j] : j], val));
+		}
+	}
+
+	/// Frees the row row_idx_in_blc of the blocs of the bloc row blc_row_idx of B
+	static void freeBlocLine(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			uint32 blc_row_idx, uint32 row_idx_in_blc)
+	{
+		for(uint32 j=0; j<B[blc_row_idx].size (); ++j)
+			if(!B[blc_row_idx][j].empty ())
+				B[blc_row_idx][j][row_idx_in_blc].free ();
+	}
+
+	/// Counts in marks a row of multiline written back, and tells whether it was the last one, so
+	/// that the multiline can be freed; the rows of a multiline can be written by two threads
+	static inline bool lastRowOfMultiline(uint8 *marks, uint32 multiline)
+	{
+		return __sync_add_and_fetch(&marks[multiline], 1) == NB_ROWS_PER_MULTILINE;
 	}
 
+	/// The row of the final matrix each pivot goes to, by its column: the pivots keep the order of
+	/// their columns
+	void newPivotRows(std::vector<uint32>& new_piv_to_row)
+	{
+		uint32 new_piv = 0;
 
+		new_piv_to_row.resize(this->coldim);
 
+		for(uint32 i=0; i < this->coldim; i++)
+		{
+			if(this->pivot_rows_idxs_by_entry[i] == MINUS_ONE)
+				continue;
+
+			new_piv_to_row[i] = new_piv;
+			new_piv++;
+		}
+	}
+
+	uint8* allocMultilineMarks(uint32 nb_rows)
+	{
+		uint8 *marks;
+
+		posix_memalign((void**)&marks, 16, (nb_rows / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
+		Level1Ops::memsetToZero(&marks, 1, nb_rows / NB_ROWS_PER_MULTILINE + 1);
+
+		return marks;
+	}
+
+
+	/**
+	 * The reconstructMatrix overloads write the rows of the echelon form to M, on NB_THREADS threads, each
+	 * row sized for its entries before they are written. M is a SparseMatrix<Element>, or any
+	 * matrix of the caller whose rows have clear (), reserve () and push_back () of a pair
+	 * (column, value), into which the rows are written directly
+	 */
+	template <typename OutputMatrix>
+	void reconstructMatrix(OutputMatrix& M, SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+									  SparseMultilineMatrix<Element>& D, bool free_matrices = false)
+	{
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > _A_dummy;
+		return reconstructMatrix(M, _A_dummy, B, D, free_matrices, true, false);
+	}
 
-	void reconstructMatrix(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	template <typename OutputMatrix>
+	void reconstructMatrix(OutputMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& D,
 			bool free_matrices = false,
 			bool A_is_null = false,
@@ -1729,36 +1990,26 @@ omp_set_dynamic(0);
 			check_equal_or_raise_exception(D.coldim(), B.coldim());
 
 
-		uint8 *vectors_to_free_AB, *vectors_to_free_D;
+		uint8 *vectors_to_free_AB = NULL, *vectors_to_free_D = NULL;
 		if(free_matrices)	//free data on the go
 		{
-			posix_memalign((void**)&vectors_to_free_AB, 16, (B.rowdim() / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
-			Level1Ops::memsetToZero(&vectors_to_free_AB, 1, B.rowdim() / NB_ROWS_PER_MULTILINE + 1);
-
-			posix_memalign((void**)&vectors_to_free_D, 16, (D.rowdim() / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
-			Level1Ops::memsetToZero(&vectors_to_free_D, 1, D.rowdim() / NB_ROWS_PER_MULTILINE + 1);
+			vectors_to_free_AB = allocMultilineMarks(B.rowdim());
+			vectors_to_free_D = allocMultilineMarks(D.rowdim());
 		}
 
-		uint32 new_piv_to_row[M.coldim()];	//To which piv in the final matrix this row it assigned
-		uint32 new_piv = 0;
-		for(uint32 i=0; i < this->coldim; i++)
-		{
-			if(this->pivot_rows_idxs_by_entry[i] == MINUS_ONE)
-				continue;
-
-			new_piv_to_row[i] = new_piv;
-			new_piv++;
-		}
+		std::vector<uint32> new_piv_to_row;	//To which piv in the final matrix this row it assigned
+		newPivotRows(new_piv_to_row);
 
 
 omp_set_dynamic(0);
 #pragma omp parallel num_threads(NB_THREADS)
 		{
-		typename SparseMatrix<Element>::Row *row_M;
+		typename OutputMatrix::Row *row_M;
 		typename SparseMultilineMatrix<Element>::Row *rowD;
-		SparseVector<Element> _tmpA, _tmpB;
-		uint32 local_piv;
+		SparseVector<Element> _tmpA;
+		uint32 pivot_row;
 		uint16 line;
+		PhaseProfiler::Scope profile (PhaseProfiler::RECONSTRUCT);
 
 #pragma omp for schedule(dynamic)
 		for(uint32 i=0; i < this->coldim; i++)
@@ -1767,73 +2018,36 @@ omp_set_dynamic(0);
 			if(this->pivot_rows_idxs_by_entry[i] == MINUS_ONE)
 				continue;
 
-			local_piv = new_piv_to_row[i];
+			pivot_row = this->pivot_rows_idxs_by_entry[i];
+			row_M = &(M[new_piv_to_row[i]]);
+			row_M->clear ();
+			PhaseProfiler::count (0, 0, 1);
 
-			if(this->pivot_rows_idxs_by_entry[i] >= this->Npiv)		//D
+			if(pivot_row >= this->Npiv)		//D
 			{
-				rowD = &(D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE]);
-				line = (this->pivot_rows_idxs_by_entry[i] - this->Npiv)%NB_ROWS_PER_MULTILINE;
-
-				row_M = &(M[local_piv]);
-				row_M->free ();
-
-				uint32 idxD;
-				if (rowD->is_sparse (D.coldim()))
-				{
-					for(uint32 j=0; j<rowD->size (); ++j)
-					{
-						idxD = rowD->IndexData[j];
-						if(rowD->at_unchecked(line, j) == 0)
-							continue;
+				const uint32 multiline = (pivot_row - this->Npiv)/NB_ROWS_PER_MULTILINE;
 
-						row_M->push_back (typename SparseMatrix<Element>::Row::value_type(
-											non_pivot_columns_rev_map[idxD],
-											rowD->at_unchecked(line, j)));
-					}
-				}
-				else
-				{
-					for(uint32 j=0; j<D.coldim (); ++j)
-					{
-						if(rowD->at_unchecked(line, j) == 0)
-							continue;
+				rowD = &(D[multiline]);
+				line = (pivot_row - this->Npiv)%NB_ROWS_PER_MULTILINE;
 
-						row_M->push_back (typename SparseMatrix<Element>::Row::value_type(
-											non_pivot_columns_rev_map[j],
-											rowD->at_unchecked(line, j)));
-					}
-				}
+				push_rowD_to_rowM(*rowD, line, D.coldim(), *row_M);
 
-				if(free_matrices)
-				{
-					if(vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
-					else	//handled all the rows in the multiline, FREE now
-					{
-						rowD->free ();
-					}
-				}
+				if(free_matrices && lastRowOfMultiline(vectors_to_free_D, multiline))
+					rowD->free ();
 			}
 			else															//A & B
 			{
 				_tmpA.clear ();
-				_tmpB.clear ();
 
 				//for each bloc of A going horizontally
-				uint32 blc_row_idx = (B.rowdim() - 1
-						- this->pivot_rows_idxs_by_entry[i]) / B.bloc_height();
-
-				uint32 row_idx_in_blc = ((B.rowdim() - 1
-						- this->pivot_rows_idxs_by_entry[i]) % B.bloc_height())
-						/ NB_ROWS_PER_MULTILINE;
+				uint32 blc_row_idx = (B.rowdim() - 1 - pivot_row) / B.bloc_height();
+				uint32 row_idx_in_blc = ((B.rowdim() - 1 - pivot_row) % B.bloc_height()) / NB_ROWS_PER_MULTILINE;
 
 				uint32 bloc_start_idx;
-				uint16 val;
+				Element val;
 				uint32 idx;
 
-				line = (B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i]) % NB_ROWS_PER_MULTILINE;
+				line = (B.rowdim() - 1 - pivot_row) % NB_ROWS_PER_MULTILINE;
 
 				if(!A_is_null)
 				{
@@ -1847,7 +2061,7 @@ omp_set_dynamic(0);
 
 						bloc_start_idx = A.coldim() - 1 - A.FirstBlocsColumIndexes[blc_row_idx] - A.bloc_width() * j;
 
-						if(A[blc_row_idx][j][row_idx_in_blc].is_sparse ())
+						if(A[blc_row_idx][j][row_idx_in_blc].is_sparse (BlocSize))
 						{
 							for (int p = A[blc_row_idx][j][row_idx_in_blc].size() - 1; p >= 0; --p)
 							{
@@ -1868,14 +2082,6 @@ omp_set_dynamic(0);
 									_tmpA.push_back(typename SparseVector<Element>::value_type(bloc_start_idx - p, val));
 							}
 						}
-
-						if(free_matrices)
-						{
-							if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
-							{
-								A[blc_row_idx][j][row_idx_in_blc].free ();
-							}
-						}
 					}
 				}
 				else	//add the identity row
@@ -1883,61 +2089,15 @@ omp_set_dynamic(0);
 					_tmpA.push_back(typename SparseVector<Element>::value_type(pivot_columns_map[i], 1));
 				}
 
-				for(int j=0; j<(int)B[blc_row_idx].size (); ++j)
-				{
-					if(B[blc_row_idx][j].empty ())
-						continue;
-
-					if(B[blc_row_idx][j][row_idx_in_blc].empty ())
-						continue;
-
-					bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
-
-					if(B[blc_row_idx][j][row_idx_in_blc].is_sparse ())
-					{
-						for (int p = 0; p<(int)B[blc_row_idx][j][row_idx_in_blc].size(); ++p)
-						{
-							idx = B[blc_row_idx][j][row_idx_in_blc].IndexData[p];
-							val = B[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-
-							if(val != 0 )
-								_tmpB.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + idx, val));
-						}
-					}
-					else
-					{
-						for (int p = 0; p < B.bloc_width (); ++p)
-						{
-							val = B[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-
-							if(val != 0)
-							{
-								_tmpB.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + p, val));
-							}
-						}
-					}
-
-					if(free_matrices)
-					{
-						if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
-						{
-							B[blc_row_idx][j][row_idx_in_blc].free ();
-						}
-					}
-				}
+				push_rowsAB_to_rowM(_tmpA, B, blc_row_idx, row_idx_in_blc, line, *row_M);
 
-				if(free_matrices)
+				if(free_matrices && lastRowOfMultiline(vectors_to_free_AB, (B.rowdim() - 1 - pivot_row)/ NB_ROWS_PER_MULTILINE))
 				{
-					if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
-				}
+					if(!A_is_null)
+						freeBlocLine(A, blc_row_idx, row_idx_in_blc);
 
-				row_M = &(M[local_piv]);
-				row_M->free ();
-				
-				push_rowsAB_to_rowM(_tmpA, _tmpB, *row_M);
+					freeBlocLine(B, blc_row_idx, row_idx_in_blc);
+				}
 			}
 		}
 	}
@@ -1957,9 +2117,10 @@ omp_set_dynamic(0);
 
 
 
-	void reconstructMatrix(SparseMatrix<Element>& M,
+	template <typename OutputMatrix>
+	void reconstructMatrix(OutputMatrix& M,
 			SparseMultilineMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			SparseMultilineMatrix<Element>& D,
 			bool free_matrices = false)
 	{
@@ -1967,36 +2128,26 @@ omp_set_dynamic(0);
 		check_equal_or_raise_exception(A.rowdim(), A.coldim());
 		check_equal_or_raise_exception(D.coldim(), B.coldim());
 
-		uint8 *vectors_to_free_AB, *vectors_to_free_D;
+		uint8 *vectors_to_free_AB = NULL, *vectors_to_free_D = NULL;
 		if(free_matrices)	//free data on the go
 		{
-			posix_memalign((void**)&vectors_to_free_AB, 16, (B.rowdim() / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
-			Level1Ops::memsetToZero(&vectors_to_free_AB, 1, B.rowdim() / NB_ROWS_PER_MULTILINE + 1);
-
-			posix_memalign((void**)&vectors_to_free_D, 16, (D.rowdim() / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
-			Level1Ops::memsetToZero(&vectors_to_free_D, 1, D.rowdim() / NB_ROWS_PER_MULTILINE + 1);
+			vectors_to_free_AB = allocMultilineMarks(B.rowdim());
+			vectors_to_free_D = allocMultilineMarks(D.rowdim());
 		}
 
-uint32 new_piv_to_row[M.coldim()];	//To which piv in the final matrix this row it assigned
-		uint32 new_piv = 0;
-		for(uint32 i=0; i < this->coldim; i++)
-		{
-			if(this->pivot_rows_idxs_by_entry[i] == MINUS_ONE)
-				continue;
-
-			new_piv_to_row[i] = new_piv;
-			new_piv++;
-		}
+		std::vector<uint32> new_piv_to_row;	//To which piv in the final matrix this row it assigned
+		newPivotRows(new_piv_to_row);
 
 
 omp_set_dynamic(0);
 #pragma omp parallel num_threads(NB_THREADS)
 		{
-		typename SparseMatrix<Element>::Row *row_M;
+		typename OutputMatrix::Row *row_M;
 		typename SparseMultilineMatrix<Element>::Row *rowD, *rowA;
-		SparseVector<Element> _tmpA, _tmpB;
-		uint32 local_piv;
+		SparseVector<Element> _tmpA;
+		uint32 pivot_row;
 		uint16 line;
+		PhaseProfiler::Scope profile (PhaseProfiler::RECONSTRUCT);
 
 
 #pragma omp for schedule(dynamic)
@@ -2006,87 +2157,43 @@ omp_set_dynamic(0);
 			if(this->pivot_rows_idxs_by_entry[i] == MINUS_ONE)
 				continue;
 
-			local_piv = new_piv_to_row[i];
+			pivot_row = this->pivot_rows_idxs_by_entry[i];
+			row_M = &(M[new_piv_to_row[i]]);
+			row_M->clear ();
+			PhaseProfiler::count (0, 0, 1);
 
-			if(this->pivot_rows_idxs_by_entry[i] >= this->Npiv)		//D
+			if(pivot_row >= this->Npiv)		//D
 			{
-				rowD = &(D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE]);
-				line = (this->pivot_rows_idxs_by_entry[i] - this->Npiv)%NB_ROWS_PER_MULTILINE;
+				const uint32 multiline = (pivot_row - this->Npiv)/NB_ROWS_PER_MULTILINE;
 
-				row_M = &(M[local_piv]);
-				row_M->clear ();
-
-				uint32 idxD;
-				if (rowD->is_sparse (D.coldim()))
-				{
-					for(uint32 j=0; j<rowD->size (); ++j)
-					{
-						idxD = rowD->IndexData[j];
-						if(rowD->at_unchecked(line, j) == 0)
-							continue;
-
-						row_M->push_back (typename SparseMatrix<Element>::Row::value_type(
-											non_pivot_columns_rev_map[idxD],
-											rowD->at_unchecked(line, j)));
-					}
-				}
-				else
-				{
-					for(uint32 j=0; j<D.coldim (); ++j)
-					{
-						if(rowD->at_unchecked(line, j) == 0)
-							continue;
+				rowD = &(D[multiline]);
+				line = (pivot_row - this->Npiv)%NB_ROWS_PER_MULTILINE;
 
-						row_M->push_back (typename SparseMatrix<Element>::Row::value_type(
-											non_pivot_columns_rev_map[j],
-											rowD->at_unchecked(line, j)));
-					}
-				}
+				push_rowD_to_rowM(*rowD, line, D.coldim(), *row_M);
 
-				if(free_matrices)
-				{
-					if(vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_D[(this->pivot_rows_idxs_by_entry[i] - this->Npiv)/NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
-					else	//handled all the rows in the multiline, FREE now
-					{
-						rowD->free ();
-					}
-				}
+				if(free_matrices && lastRowOfMultiline(vectors_to_free_D, multiline))
+					rowD->free ();
 			}
 			else															//A & B
 			{
 				_tmpA.clear ();
-				_tmpB.clear ();
 
-				//for each bloc of A going horizontally
-				uint32 blc_row_idx = (B.rowdim() - 1
-						- this->pivot_rows_idxs_by_entry[i]) / B.bloc_height();
+				uint32 blc_row_idx = (B.rowdim() - 1 - pivot_row) / B.bloc_height();
+				uint32 row_idx_in_blc = ((B.rowdim() - 1 - pivot_row) % B.bloc_height()) / NB_ROWS_PER_MULTILINE;
 
-				uint32 row_idx_in_blc = ((B.rowdim() - 1
-						- this->pivot_rows_idxs_by_entry[i]) % B.bloc_height())
-						/ NB_ROWS_PER_MULTILINE;
+				Element val;
 
-				uint32 bloc_start_idx;
-				uint16 val;
-				uint32 idx;
-
-
-
-				line = (B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i]) % NB_ROWS_PER_MULTILINE;
-				rowA = &(A[(A.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i]) / NB_ROWS_PER_MULTILINE]);
-				//line = (this->pivot_rows_idxs_by_entry[i] - this->Npiv)%NB_ROWS_PER_MULTILINE;
+				line = (B.rowdim() - 1 - pivot_row) % NB_ROWS_PER_MULTILINE;
+				rowA = &(A[(A.rowdim() - 1 - pivot_row) / NB_ROWS_PER_MULTILINE]);
 
 				if(rowA->is_sparse (A.coldim ()))
 				{
 					for(uint32 j=0; j<rowA->size (); ++j)
 					{
-						idx = rowA->IndexData[j];
 						val = rowA->at_unchecked (line, j);
 
 						if(val != 0)
-							_tmpA.push_back(typename SparseVector<Element>::value_type(idx, val));
+							_tmpA.push_back(typename SparseVector<Element>::value_type(rowA->IndexData[j], val));
 					}
 				}
 				else
@@ -2100,62 +2207,10 @@ omp_set_dynamic(0);
 					}
 				}
 
+				push_rowsAB_to_rowM(_tmpA, B, blc_row_idx, row_idx_in_blc, line, *row_M);
 
-				for(int j=0; j<(int)B[blc_row_idx].size (); ++j)
-				{
-					if(B[blc_row_idx][j].empty ())
-						continue;
-
-					if(B[blc_row_idx][j][row_idx_in_blc].empty ())
-						continue;
-
-					bloc_start_idx = B.FirstBlocsColumIndexes[blc_row_idx] + (B.bloc_width() * j);
-
-					if(B[blc_row_idx][j][row_idx_in_blc].is_sparse ())
-					{
-						for (int p = 0; p<(int)B[blc_row_idx][j][row_idx_in_blc].size(); ++p)
-						{
-							idx = B[blc_row_idx][j][row_idx_in_blc].IndexData[p];
-							val = B[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-
-							if(val != 0 )
-								_tmpB.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + idx, val));
-						}
-					}
-					else
-					{
-						for (int p = 0; p < B.bloc_width (); ++p)
-						{
-							val = B[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-
-							if(val != 0)
-							{
-								_tmpB.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + p, val));
-							}
-						}
-					}
-
-					if(free_matrices)
-					{
-						if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
-						{
-							B[blc_row_idx][j][row_idx_in_blc].free ();
-						}
-					}
-				}
-
-				if(free_matrices)
-				{
-					if(vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 0)
-					{
-						vectors_to_free_AB[(B.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-					}
-				}
-
-				row_M = &(M[local_piv]);
-				row_M->clear ();
-
-				push_rowsAB_to_rowM(_tmpA, _tmpB, *row_M);
+				if(free_matrices && lastRowOfMultiline(vectors_to_free_AB, (B.rowdim() - 1 - pivot_row)/ NB_ROWS_PER_MULTILINE))
+					freeBlocLine(B, blc_row_idx, row_idx_in_blc);
 			}
 
 		}
@@ -2178,189 +2233,95 @@ omp_set_dynamic(0);
 
 
 
-	void reconstructMatrix(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B,
+	template <typename OutputMatrix>
+	void reconstructMatrix(OutputMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			bool free_matrices = false)
 	{
-		SparseBlocMatrix<SparseMultilineBloc<Element, Index> > _A_dummy;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > _A_dummy;
 		SparseMultilineMatrix<Element> _D_dummy;
 		return reconstructMatrix(M, _A_dummy, B, _D_dummy, free_matrices, true, true);
 	}
 
 
-	void reconstructMatrix(SparseMatrix<Element>& M,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B2,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& D2,
+	template <typename OutputMatrix>
+	void reconstructMatrix(OutputMatrix& M,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B2,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D2,
 			bool free_matrices = false)
 	{
 
 		//check_equal_or_raise_exception(M.rowdim(), B2.rowdim() + D2.rowdim()); True only for Full Rank matrices
 
-		typename SparseMatrix<Element>::Row *row_M;
-		SparseVector<Element> _tmp_Left, _tmp_Right;
-
-		uint8 *vectors_to_free_B2, *vectors_to_free_D2;
+		uint8 *vectors_to_free_B2 = NULL, *vectors_to_free_D2 = NULL;
 		if(free_matrices)	//free data on the go
 		{
-			posix_memalign((void**)&vectors_to_free_B2, 16, (B2.rowdim() / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
-			Level1Ops::memsetToZero(&vectors_to_free_B2, 1, B2.rowdim() / NB_ROWS_PER_MULTILINE + 1);
-
-			posix_memalign((void**)&vectors_to_free_D2, 16, (D2.rowdim() / NB_ROWS_PER_MULTILINE + 1)  * sizeof(uint8));
-			Level1Ops::memsetToZero(&vectors_to_free_D2, 1, D2.rowdim() / NB_ROWS_PER_MULTILINE + 1);
+			vectors_to_free_B2 = allocMultilineMarks(B2.rowdim());
+			vectors_to_free_D2 = allocMultilineMarks(D2.rowdim());
 		}
 
-		uint32 piv=0;
+		std::vector<uint32> new_piv_to_row;
+		newPivotRows(new_piv_to_row);
+
+
+omp_set_dynamic(0);
+#pragma omp parallel num_threads(NB_THREADS)
+		{
+		typename OutputMatrix::Row *row_M;
+		SparseVector<Element> _tmp_Left;
+		uint32 pivot_row, multiline_rev_idx;
 		uint16 line;
+		PhaseProfiler::Scope profile (PhaseProfiler::RECONSTRUCT);
 
-		//for each bloc of A going horizontally
+#pragma omp for schedule(dynamic)
 		for(uint32 i=0; i < this->coldim; i++)
 		{
 			//TODO: handle successive rows in same multiline
 			if(this->pivot_rows_idxs_by_entry[i] == MINUS_ONE)
 				continue;
 
-			row_M = &(M[piv]);
-			row_M->free ();
+			pivot_row = this->pivot_rows_idxs_by_entry[i];
+			row_M = &(M[new_piv_to_row[i]]);
+			row_M->clear ();
+			PhaseProfiler::count (0, 0, 1);
 
-			if(this->pivot_rows_idxs_by_entry[i] >= this->Npiv)		//D
-			{
-				_tmp_Left.clear ();
-				_tmp_Right.clear ();
-
-				//for each bloc of A going horizontally
-				uint32 blc_row_idx = (D2.rowdim() - 1
-						- (this->pivot_rows_idxs_by_entry[i] - this->Npiv)) / D2.bloc_height();
-
-				uint32 row_idx_in_blc = ((D2.rowdim() - 1
-						- (this->pivot_rows_idxs_by_entry[i] - this->Npiv)) % D2.bloc_height())
-						/ NB_ROWS_PER_MULTILINE;
+			_tmp_Left.clear ();
 
-				uint32 bloc_start_idx;
-				uint16 val;
-				uint32 idx;
+			if(pivot_row >= this->Npiv)		//D
+			{
+				multiline_rev_idx = D2.rowdim() - 1 - (pivot_row - this->Npiv);
 
-				line = (D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv)) % NB_ROWS_PER_MULTILINE;
+				uint32 blc_row_idx = multiline_rev_idx / D2.bloc_height();
+				uint32 row_idx_in_blc = (multiline_rev_idx % D2.bloc_height()) / NB_ROWS_PER_MULTILINE;
+				line = multiline_rev_idx % NB_ROWS_PER_MULTILINE;
 
-				row_M->push_back (typename SparseMatrix<Element>::Row::value_type(i, 1));
+				row_M->push_back (typename OutputMatrix::Row::value_type(i, 1));
 
 				//D
-				for(int j=0; j<(int)D2[blc_row_idx].size (); ++j)
-				{
-					if(D2[blc_row_idx][j].empty ())
-						continue;
-
-					if(D2[blc_row_idx][j][row_idx_in_blc].empty ())
-						continue;
-
-					bloc_start_idx = D2.FirstBlocsColumIndexes[blc_row_idx] + (D2.bloc_width() * j);
-
-					if(D2[blc_row_idx][j][row_idx_in_blc].is_sparse ())
-					{
-						for (int p = 0; p<(int)D2[blc_row_idx][j][row_idx_in_blc].size(); ++p)
-						{
-							idx = D2[blc_row_idx][j][row_idx_in_blc].IndexData[p];
-							val = D2[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-							if(val != 0 )
-								_tmp_Right.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + idx, val));
-						}
-					}
-					else
-					{
-						for (int p = 0; p < D2.bloc_width (); ++p)
-						{
-							val = D2[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-							if(val != 0)
-								_tmp_Right.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + p, val));
-						}
-					}
-
-					if(free_matrices)
-					{
-						if(vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] == 1)
-							D2[blc_row_idx][j][row_idx_in_blc].free ();
-					}
-				}
+				push_rowsAB_to_rowM(_tmp_Left, D2, blc_row_idx, row_idx_in_blc, line, *row_M);
 
-				if(free_matrices)
-				{
-					if(vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] == 0)
-						vectors_to_free_D2[(D2.rowdim() - 1 - (this->pivot_rows_idxs_by_entry[i] - this->Npiv))/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-				}
+				if(free_matrices && lastRowOfMultiline(vectors_to_free_D2, multiline_rev_idx / NB_ROWS_PER_MULTILINE))
+					freeBlocLine(D2, blc_row_idx, row_idx_in_blc);
 			}
 			else															//A & B
 			{
-				_tmp_Left.clear ();
-				_tmp_Right.clear ();
-
-				//for each bloc of A going horizontally
-				uint32 blc_row_idx = (B2.rowdim() - 1
-						- this->pivot_rows_idxs_by_entry[i]) / B2.bloc_height();
+				multiline_rev_idx = B2.rowdim() - 1 - pivot_row;
 
-				uint32 row_idx_in_blc = ((B2.rowdim() - 1
-						- this->pivot_rows_idxs_by_entry[i]) % B2.bloc_height())
-						/ NB_ROWS_PER_MULTILINE;
-
-				uint32 bloc_start_idx;
-				uint16 val;
-				uint32 idx;
-
-				line = (B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i]) % NB_ROWS_PER_MULTILINE;
+				uint32 blc_row_idx = multiline_rev_idx / B2.bloc_height();
+				uint32 row_idx_in_blc = (multiline_rev_idx % B2.bloc_height()) / NB_ROWS_PER_MULTILINE;
+				line = multiline_rev_idx % NB_ROWS_PER_MULTILINE;
 
 				//A
 				_tmp_Left.push_back(typename SparseVector<Element>::value_type(pivot_columns_map[i], 1));
 				//equivalent row_M->push_back (typename SparseMatrix<Element>::Row::value_type(i, 1));
 
 				//B
-				for(int j=0; j<(int)B2[blc_row_idx].size (); ++j)
-				{
-					if(B2[blc_row_idx][j].empty ())
-						continue;
-
-					if(B2[blc_row_idx][j][row_idx_in_blc].empty ())
-						continue;
-
-					bloc_start_idx = B2.FirstBlocsColumIndexes[blc_row_idx] + (B2.bloc_width() * j);
-
-					if(B2[blc_row_idx][j][row_idx_in_blc].is_sparse ())
-					{
-						for (int p = 0; p<(int)B2[blc_row_idx][j][row_idx_in_blc].size(); ++p)
-						{
-							idx = B2[blc_row_idx][j][row_idx_in_blc].IndexData[p];
-							val = B2[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-							if(val != 0 )
-								_tmp_Right.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + idx, val));
-						}
-					}
-					else
-					{
-						for (int p = 0; p < B2.bloc_width (); ++p)
-						{
-							val = B2[blc_row_idx][j][row_idx_in_blc].at_unchecked(line, p);
-							if(val != 0)
-								_tmp_Right.push_back(typename SparseVector<Element>::value_type(bloc_start_idx + p, val));
-						}
-					}
-
-					if(free_matrices)
-					{
-						if(free_matrices)
-						{
-							if(vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 1)
-								B2[blc_row_idx][j][row_idx_in_blc].free ();
-						}
-					}
-				}
+				push_rowsAB_to_rowM(_tmp_Left, B2, blc_row_idx, row_idx_in_blc, line, *row_M);
 
-				if(free_matrices)
-				{
-					if(vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] == 0)
-						vectors_to_free_B2[(B2.rowdim() - 1 - this->pivot_rows_idxs_by_entry[i])/ NB_ROWS_PER_MULTILINE] = 1;	//mark it for deletion
-				}
+				if(free_matrices && lastRowOfMultiline(vectors_to_free_B2, multiline_rev_idx / NB_ROWS_PER_MULTILINE))
+					freeBlocLine(B2, blc_row_idx, row_idx_in_blc);
 			}
-
-			push_rowsAB_to_rowM(_tmp_Left, _tmp_Right, *row_M);
-
-			++piv;
+		}
 		}
 
 		if(free_matrices)
@@ -2377,7 +2338,7 @@ omp_set_dynamic(0);
 
 	///Param only_rows is used to remap the new pivots only, no columns are considered;
 	///This is basically used when the echelon form is wanted, and not the RREF
-	void combineInnerIndexer(ParallelIndexer<Element, Index>& inner_idxr, bool only_rows = false)
+	void combineInnerIndexer(ParallelIndexer<Element, Index, BlocSize>& inner_idxr, bool only_rows = false)
 	{
 		uint32 i, idx_in_B, idx_in_B2, rev_idx_in_A;
 
@@ -18,37 +18,46 @@ public:
 	/**
 	 * Given a bloc of dense rows (an array of arrays), Zeros its memory
 	 */
-	template <typename Element>
+	template <uint16 BlocSize, typename Element>
 	static inline void memsetToZero(Element** arr);
 
 	template <typename Element>
 	static inline void memsetToZero(Element** arr, const uint32 nb_lines, const uint32 line_size);
 
 
-	template<typename Ring, typename Index, typename DoubleFlatElement>
+	template<typename Ring, typename Index, uint16 BlocSize, typename DoubleFlatElement>
 	static void copySparseBlocToDenseBlocArray(const Ring& R,
-		const SparseMultilineBloc<typename Ring::Element, Index>& bloc,
+		const SparseMultilineBloc<typename Ring::Element, Index, BlocSize>& bloc,
 		DoubleFlatElement** arr);
 
 
-	template<typename Ring, typename DoubleFlatElement, typename Index>
+	template<typename Ring, typename DoubleFlatElement, typename Index, uint16 BlocSize>
 	static void copyDenseBlocArrayToSparseBloc(const Ring& R,
 		DoubleFlatElement** arr,
-		SparseMultilineBloc<typename Ring::Element, Index>& bloc,
+		SparseMultilineBloc<typename Ring::Element, Index, BlocSize>& bloc,
 		bool reduce_in_Ring = true);
 
 
-	template <typename Ring, typename DoubleFlatElement>
+	template <uint16 BlocSize, typename Ring, typename DoubleFlatElement>
 	static inline void reduceDenseArrayModulo(const Ring& R, DoubleFlatElement* arr);
 
+	/**
+	 * Reduces the size entries of arr in place with the Barrett reduction B, using the AVX2 or
+	 * AVX-512 version selected in Level2SimdOps
+	 */
+	static inline void reduceDenseArrayModulo(const BarrettReduction& B, uint64* arr, const uint32 size);
+
+	/// Same on the uint32 accumulators of Level2OpsSmallPrime
+	static inline void reduceDenseArrayModulo(const BarrettReduction& B, uint32* arr, const uint32 size);
+
 
 	template <typename Element, typename Index>
 	static inline long headMultiLineVector(const MultiLineVector<Element, Index>& v,
-			const uint16 line_idx, uint16& a, uint32& head_idx);
+			const uint16 line_idx, Element& a, uint32& head_idx);
 
 	template <typename Element, typename Index>
 	static long headMultiLineVectorHybrid(const MultiLineVector<Element, Index>& v,
-			const uint16 line_idx, uint16& a, uint32& head_idx, const size_t SIZE_DENSE_VECTOR);
+			const uint16 line_idx, Element& a, uint32& head_idx, const size_t SIZE_DENSE_VECTOR);
 
 	template<typename Ring, typename Index>
 	static inline void normalizeMultiLineVector(const Ring& R,
@@ -82,6 +91,25 @@ public:
 		const uint32 size,
 		MultiLineVector<typename Ring::Element, Index>& v);
 
+	/// Writes the NbLines dense arrays, reduced modulo R, to v in the sparse layout
+	template<typename Ring, typename Index, uint16 NbLines, typename DoubleFlatElement>
+	static void copyDenseArraysToMultilineVector(const Ring& R,
+			DoubleFlatElement * const *arrs,
+			const uint32 size,
+			MultiLineVector<typename Ring::Element, Index, NbLines>& v);
+
+	/// Copies the NbLines rows of v to the dense arrays arrs[0] .. arrs[NbLines-1]
+	template <typename Element, typename Index, uint16 NbLines, typename Element2>
+	static void copyMultiLineVectorToDenseArrays(const MultiLineVector<Element, Index, NbLines>& v,
+		Element2 **arrs, size_t arr_size);
+
+	/// Writes the NbLines dense arrays, reduced modulo R, to v; sparse or dense as HybridRepresentation decides
+	template<typename Ring, typename Index, uint16 NbLines, typename DoubleFlatElement>
+	static void copyDenseArraysToMultilineVectorHybrid(const Ring& R,
+		DoubleFlatElement * const *arrs,
+		const uint32 size,
+		MultiLineVector<typename Ring::Element, Index, NbLines>& v);
+
 private:
 	Level1Ops() {}
 	Level1Ops(const Level1Ops& other) {}
@@ -0,0 +1,69 @@
+/*
+ * level2-ops-gf2.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * The bloc reductions of Level2Ops over GF(2), on GF2Bloc: a product is an AND and a sum a XOR,
+ * so reducing a line by another is XORing its words. The blocs are reduced into a tile of
+ * BlocSize lines of BlocSize / 64 words (the accumulator), like the uint64 dense blocs of Level2Ops.
+ * A rectangular reduction by a dense tile with enough ones goes through a Four-Russians table:
+ * the XORs of the 2^8 combinations of 8 lines of the other bloc, looked up with a byte of the tile.
+ */
+
+#ifndef LEVEL2_OPS_GF2_H_
+#define LEVEL2_OPS_GF2_H_
+
+#include "consts-macros.h"
+#include "gf2-bloc.h"
+
+class Level2OpsGF2
+{
+public:
+
+	/// Lines of bloc_B combined by an entry of the Four-Russians table
+	enum { FOUR_RUSSIANS_LINES = 8, FOUR_RUSSIANS_ENTRIES = 1 << FOUR_RUSSIANS_LINES };
+
+	/// Words of the scratch table given to reduceBlocByRectangularBloc
+	template <uint16 BlocSize>
+	static uint32 tableWords () { return FOUR_RUSSIANS_ENTRIES * (BlocSize / 64); }
+
+	/// acc = acc + bloc_A * bloc_B: XORs to the line i of acc the lines j of bloc_B for the ones
+	/// (i, j) of bloc_A. table is a scratch of tableWords () words for the Four-Russians tables
+	template <typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc(const GF2Bloc<Index, BlocSize>& bloc_A,
+			const GF2Bloc<Index, BlocSize>& bloc_B,
+			uint64 **acc,
+			uint64 *table);
+
+	/// acc = bloc_A^-1 acc for bloc_A lower triangular with ones on its diagonal: the lines of acc
+	/// in order, each XORed with the lines above it for the ones of its line of bloc_A
+	template <typename Index, uint16 BlocSize>
+	static void reduceBlocByTriangularBloc(const GF2Bloc<Index, BlocSize>& bloc_A,
+			uint64 **acc);
+
+	/// Whether building the tables costs less than XORing the lines of bloc_B one by one: a table
+	/// is built for each 8 columns of bloc_A, and then read once per line
+	template <typename Index, uint16 BlocSize>
+	static bool useFourRussians (const GF2Bloc<Index, BlocSize>& bloc_A)
+	{
+		return bloc_A.isDense () && bloc_A.nbOnes () >=
+				(BlocSize / FOUR_RUSSIANS_LINES) * (FOUR_RUSSIANS_ENTRIES + BlocSize);
+	}
+
+private:
+	Level2OpsGF2() {}
+	Level2OpsGF2(const Level2OpsGF2& other) {}
+
+	template <typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc_FourRussians(const GF2Bloc<Index, BlocSize>& bloc_A,
+			const GF2Bloc<Index, BlocSize>& bloc_B,
+			uint64 **acc,
+			uint64 *table);
+};
+
+#include "level2-ops-gf2.C"
+
+#endif /* LEVEL2_OPS_GF2_H_ */
@@ -0,0 +1,128 @@
+/*
+ * level2-ops-simd.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * AVX2 and AVX-512 versions of the scal-mul-sub kernels of Level2Ops on Modular<uint16>.
+ * The kernels are compiled with per-function target attributes, so a binary built with
+ * -msse2 only still contains them; the variant is chosen once from cpuid.
+ */
+
+#ifndef LEVEL2_OPS_SIMD_H_
+#define LEVEL2_OPS_SIMD_H_
+
+#include "consts-macros.h"
+#include "types.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD_KERNELS)
+#  define HAVE_SIMD_KERNELS
+#  include <immintrin.h>
+#endif
+
+class Level2SimdOps
+{
+public:
+
+	enum Variant
+	{
+		SCALAR = 0,
+		AVX2 = 1,
+		AVX512 = 2
+	};
+
+	/// Best variant supported by the CPU (and the OS)
+	static Variant bestSupportedVariant ();
+
+	/// Variant used by the kernels; the best supported one unless selectVariant was called
+	static Variant selectedVariant () { return selected_variant (); }
+
+	/// Forces a variant given by its name ("scalar", "avx2", "avx512"), returns false if it is unknown or unsupported
+	static bool selectVariant (const char *name);
+
+	static const char* variantName (Variant v);
+
+	/**
+	 * Dispatchers called by the Level2Ops kernels: they run the vectorized kernel and return
+	 * true when one is available for the ring and the selected variant, otherwise the caller
+	 * falls back to its scalar loop.
+	 */
+	template <uint16 BlocSize, typename Element>
+	static inline bool DenseScalMulSub__one_row__array_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1, const uint32 av2_col1,
+			const uint64 *arr_source, uint64 *arr1, uint64 *arr2) { return false; }
+
+	template <uint16 BlocSize>
+	static inline bool DenseScalMulSub__one_row__array_array(const ModularAccumulator<uint16>& M,
+			const uint32 av1_col1, const uint32 av2_col1,
+			const uint64 *arr_source, uint64 *arr1, uint64 *arr2);
+
+	template <uint16 BlocSize, typename Element>
+	static inline bool DenseScalMulSub__two_rows__array_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1, const uint32 av2_col1, const uint32 av1_col2, const uint32 av2_col2,
+			const uint64 *arr_source1, const uint64 *arr_source2, uint64 *arr1, uint64 *arr2) { return false; }
+
+	template <uint16 BlocSize>
+	static inline bool DenseScalMulSub__two_rows__array_array(const ModularAccumulator<uint16>& M,
+			const uint32 av1_col1, const uint32 av2_col1, const uint32 av1_col2, const uint32 av2_col2,
+			const uint64 *arr_source1, const uint64 *arr_source2, uint64 *arr1, uint64 *arr2);
+
+	template <uint16 BlocSize, typename Element, typename Index>
+	static inline bool DenseScalMulSub__two_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1, const uint32 av2_col1, const uint32 av1_col2, const uint32 av2_col2,
+			const MultiLineVector<Element, Index>& v, uint64 *arr1, uint64 *arr2) { return false; }
+
+	template <uint16 BlocSize, typename Index>
+	static inline bool DenseScalMulSub__two_rows__vect_array(const ModularAccumulator<uint16>& M,
+			const uint32 av1_col1, const uint32 av2_col1, const uint32 av1_col2, const uint32 av2_col2,
+			const MultiLineVector<uint16, Index>& v, uint64 *arr1, uint64 *arr2);
+
+	template <typename Element, typename Index>
+	static inline bool SparseScalMulSub__two_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1, const uint32 av2_col1, const uint32 av1_col2, const uint32 av2_col2,
+			const MultiLineVector<Element, Index>& v, uint64 *arr1, uint64 *arr2) { return false; }
+
+	template <typename Index>
+	static inline bool SparseScalMulSub__two_rows__vect_array(const ModularAccumulator<uint16>& M,
+			const uint32 av1_col1, const uint32 av2_col1, const uint32 av1_col2, const uint32 av2_col2,
+			const MultiLineVector<uint16, Index>& v, uint64 *arr1, uint64 *arr2);
+
+private:
+	Level2SimdOps() {}
+	Level2SimdOps(const Level2SimdOps& other) {}
+
+	static Variant& selected_variant ();
+
+#ifdef HAVE_SIMD_KERNELS
+	/// arr1 += a1 * (src & 0xffff), arr2 += a2 * (src & 0xffff) on n entries, n multiple of 8
+	static void one_row__array_array__avx2(const uint32 a1, const uint32 a2,
+			const uint64 *src, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx2")));
+	static void one_row__array_array__avx512(const uint32 a1, const uint32 a2,
+			const uint64 *src, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx512f")));
+
+	static void two_rows__array_array__avx2(const uint32 a11, const uint32 a21, const uint32 a12, const uint32 a22,
+			const uint64 *src1, const uint64 *src2, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx2")));
+	static void two_rows__array_array__avx512(const uint32 a11, const uint32 a21, const uint32 a12, const uint32 a22,
+			const uint64 *src1, const uint64 *src2, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx512f")));
+
+	/// Same on the interleaved values of a dense multiline (val[2*i] on line 1, val[2*i+1] on line 2)
+	static void two_rows__vect_array__avx2(const uint32 a11, const uint32 a21, const uint32 a12, const uint32 a22,
+			const uint16 *val, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx2")));
+	static void two_rows__vect_array__avx512(const uint32 a11, const uint32 a21, const uint32 a12, const uint32 a22,
+			const uint16 *val, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx512f")));
+
+	/// Sparse multiline: the accumulators at the indexes of the row are gathered, updated and written back
+	template <typename Index>
+	static void sparse_two_rows__vect_array__avx2(const uint32 a11, const uint32 a21, const uint32 a12, const uint32 a22,
+			const Index *idx, const uint16 *val, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx2")));
+	template <typename Index>
+	static void sparse_two_rows__vect_array__avx512(const uint32 a11, const uint32 a21, const uint32 a12, const uint32 a22,
+			const Index *idx, const uint16 *val, uint64 *arr1, uint64 *arr2, const uint32 n) __attribute__((target("avx512f")));
+#endif
+};
+
+#include "level2-ops-simd.C"
+
+#endif /* LEVEL2_OPS_SIMD_H_ */
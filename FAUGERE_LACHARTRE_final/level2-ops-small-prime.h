@@ -0,0 +1,149 @@
+/*
+ * level2-ops-small-prime.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * The bloc reductions of Level2Ops for the moduli below 2^8, on blocs of uint8 elements and
+ * tiles of uint32 accumulators instead of uint64 ones. A product is below 2^16, so a uint32
+ * accumulator takes reductionCadence () rectangular blocs before it has to be reduced; the
+ * caller counts the blocs and calls reduceTile ().
+ * The dense and sparse kernels sum the products of the two lines of a multiline with
+ * _mm256_madd_epi16 on the interleaved values, 8 columns at a time. They serve the avx512 variant
+ * of Level2SimdOps as well: avx512f has no 16-bit multiply-add, and widening the values to 32 bits
+ * for _mm512_mullo_epi32 (and scattering the sparse rows) measured slower.
+ */
+
+#ifndef LEVEL2_OPS_SMALL_PRIME_H_
+#define LEVEL2_OPS_SMALL_PRIME_H_
+
+#include "consts-macros.h"
+#include "types.h"
+#include "level2-ops-simd.h"
+#include "phase-profiler.h"
+
+class Level2OpsSmallPrime
+{
+public:
+
+	/// The moduli of the kernels are below MAX_MODULUS
+	enum { MAX_MODULUS = 1 << 8 };
+
+	static bool supports (uint32 modulus) { return modulus < MAX_MODULUS; }
+
+	/// Reduction modulo p of the uint32 accumulators, with a multiplication by floor ((2^32 - 1) / p)
+	class Reduction
+	{
+	public:
+		Reduction (uint32 modulus) : _modulus (modulus), _inverse (~(uint32) 0 / modulus) {}
+
+		/// Reduces the n entries of arr in place
+		inline void reduce (uint32 *arr, uint32 n) const
+		{
+			for(uint32 i = 0; i < n; ++i)
+			{
+				//the quotient estimate is at most 2 below the quotient
+				uint32 r = arr[i] - (uint32) (((uint64) arr[i] * _inverse) >> 32) * _modulus;
+
+				r = r >= _modulus ? r - _modulus : r;
+				arr[i] = r >= _modulus ? r - _modulus : r;
+			}
+		}
+
+	private:
+		uint32 _modulus;
+		uint32 _inverse;
+	};
+
+	/// Rectangular blocs (or the triangular one) that can be added to a tile of accumulators below
+	/// the modulus: each adds at most BlocSize products of at most (p - 1)^2 to an entry
+	template <uint16 BlocSize>
+	static uint32 reductionCadence (uint32 modulus)
+	{
+		const uint64 max_bloc = (uint64) BlocSize * (modulus - 1) * (modulus - 1);
+
+		return (uint32) ((0xffffffffULL - (modulus - 1)) / max_bloc);
+	}
+
+	/// packed = bloc with uint8 elements, each row laid out (sparse or dense) as in bloc, in one arena
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void packBloc (const SparseMultilineBloc<Element, Index, BlocSize>& bloc,
+			SparseMultilineBloc<uint8, Index, BlocSize>& packed);
+
+	/// acc = acc - bloc_A * bloc_B (acc + bloc_A * bloc_B if !invert_scalars), without reducing acc
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc(const Modular<Element>& R,
+			const SparseMultilineBloc<uint8, Index, BlocSize>& bloc_A,
+			const SparseMultilineBloc<uint8, Index, BlocSize>& bloc_B,
+			uint32 **acc, bool invert_scalars = true);
+
+	/// acc = bloc_A^-1 acc as Level2Ops::reduceBlocByTriangularBloc; the lines of acc are
+	/// reduced one after the other, the entries of acc must leave room for one more bloc
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByTriangularBloc(const Modular<Element>& R,
+			const SparseMultilineBloc<uint8, Index, BlocSize>& bloc_A,
+			uint32 **acc, bool invert_scalars = true);
+
+	/// Reduces the BlocSize lines of acc modulo p
+	template <uint16 BlocSize>
+	static void reduceTile (const Reduction& reduction, uint32 **acc)
+	{
+		for(uint32 i = 0; i < BlocSize; ++i)
+			reduction.reduce (acc[i], BlocSize);
+	}
+
+private:
+	Level2OpsSmallPrime() {}
+	Level2OpsSmallPrime(const Level2OpsSmallPrime& other) {}
+
+	/// arr1 += a11 * v1 + a12 * v2, arr2 += a21 * v1 + a22 * v2 for the lines v1, v2 of the
+	/// multiline v, dense or sparse
+	template <uint16 BlocSize, typename Index>
+	static inline void ScalMulAdd__two_rows__vect_array(const uint32 a11, const uint32 a21,
+			const uint32 a12, const uint32 a22,
+			const MultiLineVector<uint8, Index>& v,
+			uint32 *arr1, uint32 *arr2);
+
+	/// arr1 += a1 * src, arr2 += a2 * src for a line src of reduced accumulators
+	template <uint16 BlocSize>
+	static inline void ScalMulAdd__one_row__array_array(const uint32 a1, const uint32 a2,
+			const uint32 *src, uint32 *arr1, uint32 *arr2);
+
+	/// Flops and bytes of a two rows kernel on v, for PhaseProfiler: added to flops and bytes and
+	/// to the counters of the kernel
+	template <typename Index>
+	static inline void countKernel (uint64& flops, uint64& bytes, const MultiLineVector<uint8, Index>& v)
+	{
+		const uint64 n = v.size ();
+
+		if (n == 0)
+			return;
+
+		const bool sparse = !v.IndexData._index_vector.empty ();
+		const uint64 f = 8 * n;
+		const uint64 b = n * (2 * sizeof (uint8) + (sparse ? sizeof (Index) : 0)) + 2 * n * 2 * sizeof (uint32);
+
+		flops += f;
+		bytes += b;
+		PhaseProfiler::countKernel (PhaseProfiler::SMALL_PRIME_RECTANGULAR, sparse ? PhaseProfiler::SPARSE : PhaseProfiler::DENSE,
+				Level2SimdOps::selectedVariant () != Level2SimdOps::SCALAR ? Level2SimdOps::AVX2 : Level2SimdOps::SCALAR, f, b);
+	}
+
+#ifdef HAVE_SIMD_KERNELS
+	/// The dense two rows kernel on the n interleaved values of val, n multiple of 8; coefs1 holds
+	/// a11 and a12 in its low and high 16 bits, coefs2 a21 and a22
+	static void two_rows__vect_array__avx2(const uint32 coefs1, const uint32 coefs2,
+			const uint8 *val, uint32 *arr1, uint32 *arr2, const uint32 n) __attribute__((target("avx2")));
+
+	/// Sparse multiline: the accumulators at the indexes of the row are gathered, updated and written back
+	template <typename Index>
+	static void sparse_two_rows__vect_array__avx2(const uint32 coefs1, const uint32 coefs2,
+			const Index *idx, const uint8 *val, uint32 *arr1, uint32 *arr2, const uint32 n) __attribute__((target("avx2")));
+#endif
+};
+
+#include "level2-ops-small-prime.C"
+
+#endif /* LEVEL2_OPS_SMALL_PRIME_H_ */
@@ -17,13 +17,17 @@ class Level2Ops
 {
 public:
 
-	static void DenseScalMulSub__one_row__array_array(const uint32 av1_col1,
+	template <uint16 BlocSize, typename Element>
+	static void DenseScalMulSub__one_row__array_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
 			const uint64 *arr_source,
 			uint64 *arr1,
 			uint64 *arr2) __attribute__((noinline));
 
-	static void DenseScalMulSub__two_rows__array_array(const uint32 av1_col1,
+	template <uint16 BlocSize, typename Element>
+	static void DenseScalMulSub__two_rows__array_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
 			const uint32 av1_col2,
 			const uint32 av2_col2,
@@ -32,85 +36,185 @@ public:
 			uint64 *arr1,
 			uint64 *arr2) __attribute__((noinline));
 
-	template <typename Index>
-	static void SparseScalMulSub__one_row__vect_array(const uint32 av1_col1,
+	template <typename Element, typename Index>
+	static void SparseScalMulSub__one_row__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
-			const MultiLineVector<uint16, Index>& v,
+			const MultiLineVector<Element, Index>& v,
 			const uint32 line,
 			uint64 *arr1,
 			uint64 *arr2) __attribute__((noinline));
 
-	template <typename Index>
-	static void DenseScalMulSub__one_row__vect_array(const uint32 av1_col1,
+	template <uint16 BlocSize, typename Element, typename Index>
+	static void DenseScalMulSub__one_row__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
-			const MultiLineVector<uint16, Index>& v,
+			const MultiLineVector<Element, Index>& v,
 			const uint32 line,
 			uint64 *arr1,
 			uint64 *arr2) __attribute__((noinline));
 
 
-	template <typename Index>
-	static void DenseScalMulSub__two_rows__vect_array(const uint32 av1_col1,
+	template <uint16 BlocSize, typename Element, typename Index>
+	static void DenseScalMulSub__two_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
 			const uint32 av1_col2,
 			const uint32 av2_col2,
-			const MultiLineVector<uint16, Index>& v,
+			const MultiLineVector<Element, Index>& v,
 			uint64 *arr1,
 			uint64 *arr2) __attribute__((noinline));
 
-	template <typename Index>
-	static void SparseScalMulSub__two_rows__vect_array(const uint32 av1_col1,
+	template <typename Element, typename Index>
+	static void SparseScalMulSub__two_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
 			const uint32 av1_col2,
 			const uint32 av2_col2,
-			const MultiLineVector<uint16, Index>& v,
+			const MultiLineVector<Element, Index>& v,
 			uint64 *arr1,
 			uint64 *arr2) __attribute__((noinline));
 
+	/// Same as the Sparse kernels on a row v in the bitmap layout (see MultiLineVector::is_bitmap)
+	template <uint16 BlocSize, typename Element, typename Index>
+	static void BitmapScalMulSub__one_row__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
+			const uint32 av2_col1,
+			const MultiLineVector<Element, Index>& v,
+			const uint32 line,
+			uint64 *arr1,
+			uint64 *arr2) __attribute__((noinline));
 
-	template <typename Index>
-	static void reduceBlocByRectangularBloc(const Modular<uint16>& R,
-			const SparseMultilineBloc<uint16, Index>& bloc_A,
-			const SparseMultilineBloc<uint16, Index>& bloc_B,
+	template <uint16 BlocSize, typename Element, typename Index>
+	static void BitmapScalMulSub__two_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
+			const uint32 av2_col1,
+			const uint32 av1_col2,
+			const uint32 av2_col2,
+			const MultiLineVector<Element, Index>& v,
+			uint64 *arr1,
+			uint64 *arr2) __attribute__((noinline));
+
+	/**
+	 * arrs[r] += sum over the lines l of v of coefs[r][l] * (line l of v), for r < NbLines.
+	 * With NbLines = 2 and coefs = {{av1_col1, av1_col2}, {av2_col1, av2_col2}}, this is
+	 * the __two_rows__ kernel; each value loaded from v is used NbLines times
+	 */
+	template <typename Element, typename Index, uint16 NbLines>
+	static void SparseScalMulSub__N_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 coefs[NbLines][NbLines],
+			const MultiLineVector<Element, Index, NbLines>& v,
+			uint64 * const *arrs) __attribute__((noinline));
+
+	template <uint16 BlocSize, typename Element, typename Index, uint16 NbLines>
+	static void DenseScalMulSub__N_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 coefs[NbLines][NbLines],
+			const MultiLineVector<Element, Index, NbLines>& v,
+			uint64 * const *arrs) __attribute__((noinline));
+
+
+	/// SparseScalMulSub__N_rows__vect_array on the multilines of the engine, which goes to the
+	/// __two_rows__ kernel and its SIMD versions when they have 2 rows
+	template <typename Element, typename Index>
+	static inline void SparseScalMulSub__multiline__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 coefs[NB_ROWS_PER_MULTILINE][NB_ROWS_PER_MULTILINE],
+			const MultiLineVector<Element, Index>& v,
+			uint64 * const *arrs);
+
+	/// Same on a dense row v of any size, from the entry start_offset on
+	template <typename Element, typename Index, uint16 NbLines>
+	static void DenseScalMulSub__N_rows__vect_array__variable_size(const ModularAccumulator<Element>& M,
+			const uint32 coefs[NbLines][NbLines],
+			const MultiLineVector<Element, Index, NbLines>& v,
+			uint64 * const *arrs,
+			const int start_offset = 0);
+
+	/// Same on a row v in the bitmap layout
+	template <uint16 BlocSize, typename Element, typename Index, uint16 NbLines>
+	static void BitmapScalMulSub__N_rows__vect_array(const ModularAccumulator<Element>& M,
+			const uint32 coefs[NbLines][NbLines],
+			const MultiLineVector<Element, Index, NbLines>& v,
+			uint64 * const *arrs) __attribute__((noinline));
+
+	/// arrs[r] += sum over l of coefs[r][l] * arrs_source[l], on dense arrays of BlocSize entries
+	template <uint16 BlocSize, typename Element, uint16 NbLines>
+	static void DenseScalMulSub__N_rows__array_array(const ModularAccumulator<Element>& M,
+			const uint32 coefs[NbLines][NbLines],
+			uint64 * const *arrs_source,
+			uint64 * const *arrs) __attribute__((noinline));
+
+
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_B,
 			uint64 **Bloc_acc, bool invert_scalars = true) __attribute__((noinline));
 
 
 	/**
 	 * Reduce the rows inside the bloc by themselves
 	 */
-	template<typename Index>
-	static void reduceBlocByTriangularBloc(const Modular<uint16>& R,
-			const SparseMultilineBloc<uint16, Index>& bloc_A,
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByTriangularBloc(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A,
 			uint64** Bloc_acc, bool invert_scalars = true) __attribute__((noinline));
 
-	template<typename Index>
-	static void reduceBlocByRectangularBloc_C(const Modular<uint16>& R,
-			const SparseMultilineBloc<uint16, Index>& bloc_C,
-			const SparseMultilineBloc<uint16, Index>& bloc_A, uint64 **bloc_dense);
+	/**
+	 * The two functions above on multilines of NB_ROWS_PER_MULTILINE rows other than 2: the
+	 * columns of bloc_A falling in the same multiline are applied with the __N_rows__ kernels
+	 */
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc__N_rows(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_B,
+			uint64 **Bloc_acc, bool invert_scalars) __attribute__((noinline));
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByTriangularBloc__N_rows(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A,
+			uint64** Bloc_acc, bool invert_scalars) __attribute__((noinline));
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc_C(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_C,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A, uint64 **bloc_dense);
+
+
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByTriangularBloc_C(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A,
+			uint64 **bloc_dense);
 
+	//the two functions above on multilines of NB_ROWS_PER_MULTILINE rows other than 2
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByRectangularBloc_C__N_rows(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_C,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A, uint64 **bloc_dense);
 
-	template <typename Index>
-	static void reduceBlocByTriangularBloc_C(const Modular<uint16>& R,
-			const SparseMultilineBloc<uint16, Index>& bloc_A,
+	template <typename Element, typename Index, uint16 BlocSize>
+	static void reduceBlocByTriangularBloc_C__N_rows(const Modular<Element>& R,
+			const SparseMultilineBloc<Element, Index, BlocSize>& bloc_A,
 			uint64 **bloc_dense);
 
 
-	template <typename Index>
-	static void DenseScalMulSub__one_row__vect_array__variable_size(const uint32 av1_col1,
+	template <typename Element, typename Index>
+	static void DenseScalMulSub__one_row__vect_array__variable_size(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
-			const MultiLineVector<uint16, Index>& v,
+			const MultiLineVector<Element, Index>& v,
 			const uint32 line,
 			uint64 *arr1,
 			uint64 *arr2,
 			const int start_offset = 0);
 
 
-	template <typename Index>
-	static void DenseScalMulSub__two_rows__vect_array__variable_size(const uint32 av1_col1,
+	template <typename Element, typename Index>
+	static void DenseScalMulSub__two_rows__vect_array__variable_size(const ModularAccumulator<Element>& M,
+			const uint32 av1_col1,
 			const uint32 av2_col1,
 			const uint32 av1_col2,
 			const uint32 av2_col2,
-			const MultiLineVector<uint16, Index>& v,
+			const MultiLineVector<Element, Index>& v,
 			uint64 *arr1,
 			uint64 *arr2,
 			const int start_offset = 0);
@@ -11,6 +11,7 @@
 
 #include "lela/matrix/sparse.h"
 #include "level2-ops.h"
+#include "level3Parallel_echelon.h"
 
 using namespace LELA;
 
@@ -18,68 +19,68 @@ class Level3Ops
 {
 public:
 
-	template<typename Index>
-	static void reducePivotsByPivots(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B);
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reducePivotsByPivots(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 
 
-	template<typename Index>
-	static void reduceNonPivotsByPivots(const Modular<uint16>& R,
-		const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& C,
-		const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B,
-		SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& D,
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceNonPivotsByPivots(const Modular<Element>& R,
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 		bool invert_scalars = true);
 
-	template<typename Index>
-	static void reduceC(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& C);
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceC(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C);
 
-	template<typename Index>
-	static void reduceC(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseMultilineMatrix<uint16>& C);
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceC(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseMultilineMatrix<Element>& C);
 
 	template<typename Ring>
 	static void reduceC(const Ring& R,
-			const SparseMultilineMatrix<uint16>& A,
-			SparseMultilineMatrix<uint16>& C);
+			const SparseMultilineMatrix<typename Ring::Element>& A,
+			SparseMultilineMatrix<typename Ring::Element>& C);
 
-	template<typename Index>
-	static uint32 echelonize(const Modular<uint16>& R,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& inMatrix,
-			SparseMultilineMatrix<uint16>& outMatrix, bool destruct_in_matrix = true, bool use_hybrid_method = true);
+	template<typename Element, typename Index, uint16 BlocSize>
+	static uint32 echelonize(const Modular<Element>& R,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& inMatrix,
+			SparseMultilineMatrix<Element>& outMatrix, bool destruct_in_matrix = true, bool use_hybrid_method = true);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void copyMultilineMatrixToBlocMatrixRTL(SparseMultilineMatrix<Element>& A,
-		SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B, bool destruct_riginal = true);
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B, bool destruct_riginal = true);
 
 
 	/***************************************************************************************************/
-	template<typename Index>
-	static void reducePivotsByPivots_horizontal(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B);
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reducePivotsByPivots_horizontal(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 	
-	template<typename Index>
-	static void reduceNonPivotsByPivots_horizontal(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& C,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& D,
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceNonPivotsByPivots_horizontal(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool invert_scalars = true);
 	
 private:
 	Level3Ops() {}
 	Level3Ops(const Level3Ops& other) {}
 
-	template <typename Index>
-	static uint32 echelonize_in_sparse(const Modular<uint16>& R,
-			SparseMultilineMatrix<uint16, Index>& A);
+	template <typename Element, typename Index>
+	static uint32 echelonize_in_sparse(const Modular<Element>& R,
+			SparseMultilineMatrix<Element, Index>& A);
 
-	template <typename Index>
-	static uint32 echelonize_in_hybrid(const Modular<uint16>& R,
-			SparseMultilineMatrix<uint16, Index>& A);
+	template <typename Element, typename Index>
+	static uint32 echelonize_in_hybrid(const Modular<Element>& R,
+			SparseMultilineMatrix<Element, Index>& A);
 
 };
 
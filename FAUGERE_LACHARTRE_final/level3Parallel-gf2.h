@@ -0,0 +1,92 @@
+/*
+ * level3Parallel-gf2.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * B = A^-1 B and D = D - C*B of Level3ParallelOps for the matrices of modulus 2, on the kernels
+ * of Level2OpsGF2. The matrices are the SparseMultilineBloc ones built by the indexer; the blocs
+ * read by the kernels (A, C and the reduced blocs of B) are packed to GF2Bloc first, and the
+ * results written back, so that the rest of the pipeline (the echelon form of D, the
+ * reconstruction) runs unchanged.
+ */
+
+#ifndef LEVEL3PARALLEL_GF2_H_
+#define LEVEL3PARALLEL_GF2_H_
+
+#include "consts-macros.h"
+#include "types.h"
+#include "gf2-bloc.h"
+#include "level2-ops-gf2.h"
+#include "work-stealing-scheduler.h"
+#include "worker-pool.h"
+
+class Level3ParallelGF2Ops
+{
+public:
+
+	/// P = M with one bit per entry, the non zero entries of M being the ones; P has the shape
+	/// and the arrangement of M. One task per row of blocs
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void packBlocMatrix(const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& M,
+		SparseBlocMatrix<GF2Bloc<Index, BlocSize> >& P,
+		int NB_THREADS);
+
+	/// B = A^-1 B over GF(2); one task per column of blocs of B
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reducePivotsByPivots__Parallel(const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+		int NB_THREADS);
+
+	/// D = D - C*B over GF(2), where D - C*B = D + C*B; one task per bloc of D
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceNonPivotsByPivots__Parallel(const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
+		int NB_THREADS);
+
+private:
+	Level3ParallelGF2Ops() {}
+	Level3ParallelGF2Ops(const Level3ParallelGF2Ops& other) {}
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	struct Pack_Params_t {
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* M;
+		SparseBlocMatrix<GF2Bloc<Index, BlocSize> >* P;
+		WorkStealingScheduler* scheduler;
+		uint32 thread_id;
+	};
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	struct ReducePivotsByPivots_Params_t {
+		const SparseBlocMatrix<GF2Bloc<Index, BlocSize> >* A;
+		SparseBlocMatrix<GF2Bloc<Index, BlocSize> >* packed_B;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* B;
+		WorkStealingScheduler* scheduler;
+		uint32 thread_id;
+	};
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	struct ReduceNonPivotsByPivots_Params_t {
+		const SparseBlocMatrix<GF2Bloc<Index, BlocSize> >* C;
+		const SparseBlocMatrix<GF2Bloc<Index, BlocSize> >* B;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* D;
+		WorkStealingScheduler* scheduler;
+		uint32 thread_id;
+	};
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void* packBlocMatrix_in(void* p_params);
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void* reducePivotsByPivots__Parallel_in(void* p_params);
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void* reduceNonPivotsByPivots__Parallel_in(void* p_params);
+};
+
+#include "level3Parallel-gf2.C"
+
+#endif /* LEVEL3PARALLEL_GF2_H_ */
@@ -0,0 +1,101 @@
+/*
+ * level3Parallel-small-prime.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * B = A^-1 B and D = D - C*B of Level3ParallelOps for the moduli below 2^8, on the kernels of
+ * Level2OpsSmallPrime. The blocs read by the kernels (A, C and the reduced blocs of B) are
+ * packed to uint8 elements first and each bloc is reduced in a tile of uint32 accumulators,
+ * reduced modulo p every reductionCadence () blocs; the results are written back to the
+ * matrices of the engine, so that the rest of the pipeline runs unchanged.
+ */
+
+#ifndef LEVEL3PARALLEL_SMALL_PRIME_H_
+#define LEVEL3PARALLEL_SMALL_PRIME_H_
+
+#include "consts-macros.h"
+#include "types.h"
+#include "level1-ops.h"
+#include "level2-ops-small-prime.h"
+#include "work-stealing-scheduler.h"
+#include "worker-pool.h"
+
+class Level3ParallelSmallPrimeOps
+{
+public:
+
+	/// P = M with uint8 elements, same shape and arrangement; one task per row of blocs
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void packBlocMatrix(const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& M,
+		SparseBlocMatrix<SparseMultilineBloc<uint8, Index, BlocSize> >& P,
+		int NB_THREADS);
+
+	/// B = A^-1 B; one task per column of blocs of B
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reducePivotsByPivots__Parallel(const Modular<Element>& R,
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+		int NB_THREADS);
+
+	/// D = D - C*B; one task per bloc of D
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void reduceNonPivotsByPivots__Parallel(const Modular<Element>& R,
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
+		bool invert_scalars,
+		int NB_THREADS);
+
+private:
+	Level3ParallelSmallPrimeOps() {}
+	Level3ParallelSmallPrimeOps(const Level3ParallelSmallPrimeOps& other) {}
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	struct Pack_Params_t {
+		const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* M;
+		SparseBlocMatrix<SparseMultilineBloc<uint8, Index, BlocSize> >* P;
+		WorkStealingScheduler* scheduler;
+		uint32 thread_id;
+	};
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	struct ReducePivotsByPivots_Params_t {
+		const Modular<Element>* R;
+		const SparseBlocMatrix<SparseMultilineBloc<uint8, Index, BlocSize> >* A;
+		SparseBlocMatrix<SparseMultilineBloc<uint8, Index, BlocSize> >* packed_B;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* B;
+		WorkStealingScheduler* scheduler;
+		uint32 thread_id;
+	};
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	struct ReduceNonPivotsByPivots_Params_t {
+		const Modular<Element>* R;
+		const SparseBlocMatrix<SparseMultilineBloc<uint8, Index, BlocSize> >* C;
+		const SparseBlocMatrix<SparseMultilineBloc<uint8, Index, BlocSize> >* B;
+		SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* D;
+		bool invert_scalars;
+		WorkStealingScheduler* scheduler;
+		uint32 thread_id;
+	};
+
+	/// Points acc[0..BlocSize-1] to the lines of a tile of uint32 accumulators of the calling worker
+	template<uint16 BlocSize>
+	static void scratchTile(uint32 **acc);
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void* packBlocMatrix_in(void* p_params);
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void* reducePivotsByPivots__Parallel_in(void* p_params);
+
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void* reduceNonPivotsByPivots__Parallel_in(void* p_params);
+};
+
+#include "level3Parallel-small-prime.C"
+
+#endif /* LEVEL3PARALLEL_SMALL_PRIME_H_ */
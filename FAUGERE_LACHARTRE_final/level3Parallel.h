@@ -14,6 +14,10 @@
 
 #include "lela/matrix/sparse.h"
 #include "level2-ops.h"
+#include "work-stealing-scheduler.h"
+#include "dataflow-scheduler.h"
+#include "worker-pool.h"
+#include "bloc-column-store.h"
 
 using namespace LELA;
 
@@ -21,92 +25,165 @@ class Level3ParallelOps
 {
 
 public:
-		template<typename Index>
-		static void reducePivotsByPivots__Parallel(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B,
+		/// B = A^-1 B; runs reducePivotsByPivots__Parallel_columns when B has enough columns of blocs
+		/// to feed all the threads, reducePivotsByPivots__Parallel_dataflow otherwise
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reducePivotsByPivots__Parallel(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
 			int NB_THREADS);
 
-		template<typename Index>
-		static void reduceNonPivotsByPivots__Parallel(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& C,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& D,
+		/// One task per column of blocs of B, each column is swept top down by a single thread
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reducePivotsByPivots__Parallel_columns(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			int NB_THREADS);
+
+		/// One task per bloc of B, a bloc is reduced as soon as the blocs of B it reads are final;
+		/// left-looking: a task pulls the updates of the blocs above it (waitDone) into its own bloc
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reducePivotsByPivots__Parallel_dataflow(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			int NB_THREADS);
+
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reduceNonPivotsByPivots__Parallel(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool invert_scalars ,
 			int NB_THREADS);
 		
-		template<typename Index>
-		static void reduceNonPivotsByPivots__Parallel_horizontal(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& C,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& D,
+		/// D = D - C*B with B and D spilled to disk: the columns are reduced one after the other, all
+		/// the threads working on the blocs of the current one, while the next ones are prefetched
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reduceNonPivotsByPivots__OutOfCore(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			BlocColumnStore<SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > >& B,
+			BlocColumnStore<SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > >& D,
+			bool invert_scalars,
+			int NB_THREADS);
+
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reduceNonPivotsByPivots__Parallel_horizontal(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& C,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& D,
 			bool invert_scalars ,
 			int NB_THREADS);
 
+		/// Lays out the sparse rows of B whose density HybridRepresentation::isBitmap () selects as
+		/// bitmaps (bitmap true), or all the bitmap rows of B back as sparse rows (bitmap false)
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void setBitmapLayout__Parallel(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B,
+			bool bitmap,
+			int NB_THREADS);
+
 		template<typename Ring>
 		static void reduceC__Parallel(const Ring& R,
-				const SparseMultilineMatrix<uint16>& A,
-				SparseMultilineMatrix<uint16>& C, int NB_THREADS);
+				const SparseMultilineMatrix<typename Ring::Element>& A,
+				SparseMultilineMatrix<typename Ring::Element>& C, int NB_THREADS);
 
 
-		template<typename Index>
-		static void reducePivotsByPivots_2_Level_Parallel(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B);
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reducePivotsByPivots_2_Level_Parallel(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 
-		template<typename Index>
-		static void reducePivotsByPivots__Parallel_thread_pool(const Modular<uint16>& R,
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& A,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& B);
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void reducePivotsByPivots__Parallel_thread_pool(const Modular<Element>& R,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 
 
-		template<typename Element, typename Index>
+		template<typename Element, typename Index, uint16 BlocSize>
 		static void copyMultilineMatrixToBlocMatrixRTL__Parallel(SparseMultilineMatrix<Element>& A,
-				SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B, bool destruct_riginal, int NUM_THREADS);
+				SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B, bool destruct_riginal, int NUM_THREADS);
 
-		typedef struct reduceBlocByRectangularBloc_thread_pool_Params_t {
-			const Modular<uint16>* R;
-			const SparseMultilineBloc<uint16, IndexType>* bloc_A;
-			const SparseMultilineBloc<uint16, IndexType>* bloc_B;
+		template<typename Element, typename Index, uint16 BlocSize>
+		struct reduceBlocByRectangularBloc_thread_pool_Params_t {
+			const Modular<Element>* R;
+			const SparseMultilineBloc<Element, Index, BlocSize>* bloc_A;
+			const SparseMultilineBloc<Element, Index, BlocSize>* bloc_B;
 			uint64 **Bloc_acc;
 			bool invert_scalars;
 			int from;
 			int to;
-		} reduceBlocByRectangularBloc_thread_pool_Params_t;
+		};
 
 private:
-		typedef struct ReduceC_Params_t {
-			typedef Modular<uint16> Ring;
+		template<typename Element>
+		struct ReduceC_Params_t {
+			typedef Modular<Element> Ring;
 			const Ring* R;
-			const SparseMultilineMatrix<uint16>* A;
-			SparseMultilineMatrix<uint16>* C;
-		} ReduceC_Params_t;
+			const SparseMultilineMatrix<Element>* A;
+			SparseMultilineMatrix<Element>* C;
+			WorkStealingScheduler* scheduler;
+			uint32 thread_id;
+		};
 
 
+		template<typename Element, typename Index, uint16 BlocSize>
 		struct ReducePivotsByPivots_Params_t {
-			typedef Modular<uint16> Ring;
-			typedef SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> > BlocMatrix;
+			typedef Modular<Element> Ring;
+			typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > BlocMatrix;
+			const Ring* R;
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* A;
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* B;
+			WorkStealingScheduler* scheduler;
+			uint32 thread_id;
+		};
+
+		template<typename Element, typename Index, uint16 BlocSize>
+		struct ReducePivotsByPivotsDataflow_Params_t {
+			typedef Modular<Element> Ring;
 			const Ring* R;
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> >* A;
-			SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> >* B;
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* A;
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* B;
+			DataflowScheduler* scheduler;
+			uint32 nb_column_blocs_B;
 		};
 
+		template<typename Element, typename Index, uint16 BlocSize>
 		struct ReduceNonPivotsByPivots_Params_t {
-			typedef Modular<uint16> Ring;
-			typedef SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> > BlocMatrix;
+			typedef Modular<Element> Ring;
+			typedef SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> > BlocMatrix;
 			const Ring* R;
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> >* C;
-			const SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> >* B;
-			SparseBlocMatrix<SparseMultilineBloc<uint16, IndexType> >* D;
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* C;
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* B;
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* D;
 			bool invert_scalars;
+			WorkStealingScheduler* scheduler;
+			uint32 thread_id;
+			uint32 first_column;		//bloc column of D of the task 0
 		};
 
+		template<typename Element, typename Index, uint16 BlocSize>
+		struct SetBitmapLayout_Params_t {
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >* B;
+			bool bitmap;
+			WorkStealingScheduler* scheduler;
+			uint32 thread_id;
+		};
+
+		template<typename Element>
 		static void* reduceC__Parallel_in(void* p_params);
 
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void* setBitmapLayout__Parallel_in(void* p_params);
+
+		template<typename Element, typename Index, uint16 BlocSize>
 		static void* reducePivotsByPivots__Parallel_in(void* p_params);
 
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void* reducePivotsByPivots__Parallel_dataflow_in(void* p_params);
+
+		template<typename Element, typename Index, uint16 BlocSize>
 		static void* reduceNonPivotsByPivots__Parallel_in(void* p_params);
 		
+		template<typename Element, typename Index, uint16 BlocSize>
 		static void* reduceNonPivotsByPivots__Parallel_horizontal_in(void* p_params);
 
 		static void* reduceBlocByRectangularBloc_thread_pool(void *p_params);
@@ -12,64 +12,130 @@
 
 
 #include "lela/matrix/sparse.h"
+#include "lela/matrix/dense.h"
+#include "lela/ring/modular.h"
+#include "lela/algorithms/gauss-jordan.h"
+#include "lela/algorithms/elimination.h"
 #include "level2-ops.h"
+#include "worker-pool.h"
 
 using namespace LELA;
 
+/**
+ * Density of D (non zero entries / rowdim x coldim) from which it is echelonized with
+ * echelonize__Dense rather than echelonize__Parallel; 0 disables it. The dense elimination
+ * only pays off when the matrix products of Gauss-Jordan run on a BLAS dgemm
+ */
+#ifdef __LELA_BLAS_AVAILABLE
+#define DENSE_ECHELON_THRESHOLD 0.3f
+#else
+#define DENSE_ECHELON_THRESHOLD 0.0f
+#endif
+
+/// Largest modulus for which the products of echelonize__Dense are exact in doubles
+#define DENSE_ECHELON_MAX_MODULUS (1U << 26)
+
 class Level3ParallelEchelon
 {
 
 public:
-	template<typename Index>
-	static uint32 echelonize__Parallel(const Modular<uint16>& R,
-			SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& inMatrix,
-			SparseMultilineMatrix<uint16>& outMatrix, bool destruct_in_matrix,
+	template<typename Element, typename Index, uint16 BlocSize>
+	static uint32 echelonize__Parallel(const Modular<Element>& R,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& inMatrix,
+			SparseMultilineMatrix<Element>& outMatrix, bool destruct_in_matrix,
 			int NB_THREADS);
 
+	/**
+	 * Same input and output as echelonize__Parallel, but inMatrix is copied to a DenseMatrix over
+	 * Modular<double> and echelonized with LELA's asymptotically fast Gauss-Jordan, whose matrix
+	 * products go to cblas_dgemm when BLAS is available. The modulus of R must be at most
+	 * DENSE_ECHELON_MAX_MODULUS
+	 */
+	template<typename Element, typename Index, uint16 BlocSize>
+	static uint32 echelonize__Dense(const Modular<Element>& R,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& inMatrix,
+			SparseMultilineMatrix<Element>& outMatrix, bool destruct_in_matrix,
+			int NB_THREADS);
+
+	/**
+	 * Echelonizes the rows from_row .. to_row of the multiline matrix A one after the other, each
+	 * reduced by all the rows before it; returns the number of non zero rows. Level3Ops::echelonize
+	 * uses it on multilines of NB_ROWS_PER_MULTILINE rows other than 2
+	 */
+	template <typename Element, typename Index>
+	static uint32 echelonizeRowUpTo_Sequential(const Modular<Element>& R,
+			SparseMultilineMatrix<Element, Index>& A,
+			uint32 from_row,
+			uint32 to_row);
+
 	typedef struct waiting_row_t {
 			uint32 row_idx;
 			uint32 last_pivot_reduced_by;
 	} waiting_row_t;
 
 private:
-		typedef struct echelonize_Params_t {
-			typedef Modular<uint16> Ring;
+		template<typename Element>
+		struct echelonize_Params_t {
+			typedef Modular<Element> Ring;
 			const Ring* R;
-			SparseMultilineMatrix<uint16>* A;
-		} echelonize_Params_t;
+			SparseMultilineMatrix<Element>* A;
+		};
 		
+		template<typename Element>
 		static void* echelonize__Parallel_in(void* p_params);
 
-		template<typename Index>
-		static void copyBlocMatrixToMultilineMatrix(SparseBlocMatrix<SparseMultilineBloc<uint16, Index> >& inMatrix,
-			SparseMultilineMatrix<uint16>& outMatrix, bool destruct_in_matrix, int NB_THREADS);
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void copyBlocMatrixToMultilineMatrix(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& inMatrix,
+			SparseMultilineMatrix<Element>& outMatrix, bool destruct_in_matrix, int NB_THREADS);
+
+		//line l of the multiline row i is the row NB_ROWS_PER_MULTILINE*i + l of outMatrix; the entries are reduced modulo R
+		template<typename Element, typename Index, uint16 BlocSize>
+		static void copyBlocMatrixToDenseMatrix(const Modular<Element>& R,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& inMatrix,
+			DenseMatrix<double>& outMatrix, bool destruct_in_matrix, int NB_THREADS);
+
+		//the rows of inMatrix are normalized on the way
+		template<typename Element>
+		static void copyDenseMatrixToMultilineMatrix(const Modular<Element>& R, const DenseMatrix<double>& inMatrix,
+			SparseMultilineMatrix<Element>& outMatrix, int NB_THREADS);
 
 		static bool getSmallestWaitingRow(waiting_row_t* elt);
 
 		static void pushRowToWaitingList(uint32 row_idx, uint32 last_pivot_reduced_by);
 
-		template <typename Index>
-		static inline void echelonize_one_row(const Modular<uint16>& R,
-					SparseMultilineMatrix<uint16, Index>& A,
+		template <typename Element, typename Index>
+		static inline void echelonize_one_row(const Modular<Element>& R,
+					SparseMultilineMatrix<Element, Index>& A,
 					uint32 idx_row_to_echelonize,
 					uint32 first_pivot,
 					uint32 last_pivot,
-					uint64 *tmpDenseArray1,
-					uint64 *tmpDenseArray2);
+					uint64 **tmpDenseArrays);
+
+		template <typename Element, typename Index>
+		static inline void saveBackAndReduce(const Modular<Element>& R,
+					SparseMultilineMatrix<Element, Index>& A,
+					uint32 row_idx,
+					uint64 **tmpDenseArrays,
+					bool reduce);
+
+		//the two functions above on multilines of NB_ROWS_PER_MULTILINE rows other than 2
+		template <typename Element, typename Index>
+		static void echelonize_one_row__N_rows(const Modular<Element>& R,
+					SparseMultilineMatrix<Element, Index>& A,
+					uint32 first_pivot,
+					uint32 last_pivot,
+					uint64 **tmpDenseArrays);
 
-		template <typename Index>
-		static inline void saveBackAndReduce(const Modular<uint16>& R,
-					SparseMultilineMatrix<uint16, Index>& A,
+		template <typename Element, typename Index>
+		static void saveBackAndReduce__N_rows(const Modular<Element>& R,
+					SparseMultilineMatrix<Element, Index>& A,
 					uint32 row_idx,
-					uint64 *tmpDenseArray1,
-					uint64 *tmpDenseArray2,
+					uint64 **tmpDenseArrays,
 					bool reduce);
 
-		template <typename Index>
-		static uint32 echelonizeRowUpTo_Sequential(const Modular<uint16>& R,
-				SparseMultilineMatrix<uint16, Index>& A,
-				uint32 from_row,
-				uint32 to_row);
+		//the number of lines of v which are not zero
+		template <typename Element, typename Index>
+		static inline uint32 nbNonZeroLines(const MultiLineVector<Element, Index>& v, uint32 coldim);
 };
 
 
@@ -14,6 +14,8 @@
 #include "lela/ring/modular.h"
 #include "lela/matrix/sparse.h"
 #include "types.h"
+#include "f4-matrix-view.h"
+#include "f4-file-stream.h"
 
 using namespace LELA;
 
@@ -74,29 +76,37 @@ class MatrixUtils
 {
 
 public:
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void copy(const SparseMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B);
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
+
+	/// B = A, where A is a SparseMatrix or an F4MatrixView (matrix file mapped in memory)
+	template<typename SourceMatrix, typename Element>
+	static void copyRows(const SourceMatrix& A, SparseMatrix<Element>& B);
+
+	/// Same, the rows are read from the file by blocs of rows
+	template<typename Element>
+	static void copyRows(const F4FileStream<Element>& A, SparseMatrix<Element>& B);
 
 	//WRANING: these functions have side effects on entry matrices, generaly the data is changed
 	//from haybrid to sparse a vice versa, or destructed when specified
-	template<typename Element, typename Index>
-	static void copy(SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+	template<typename Element, typename Index, uint16 BlocSize>
+	static void copy(SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			SparseMatrix<Element>& B, bool destruct_original = false);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void transformSparseToHybridRows(
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A);
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void transformHybridToSparseRows(
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A);
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A);
 
 	///dumps the matrix content as a PBM image. null elements are represented with a white pixel
 	///other elements are represented with a black pixel
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void dumpMatrixAsPbmImage(
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			const char *outputFileName);
 
 	///dumps the matrix content as a PBM image. null elements are represented with a white pixel
@@ -105,19 +115,33 @@ public:
 	static void dumpMatrixAsPbmImage(const SparseMatrix<Element>& A,
 			const char *outputFileName);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static bool equal(const Modular<Element>& R,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			const SparseMatrix<Element>& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static bool equal(const Modular<Element>& R, const SparseMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B);
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 
 	static void show_mem_usage(std::string msg);
 
+	/**
+	 * Chooses a bloc size among SUPPORTED_BLOC_SIZES from the shape of the matrix:
+	 * the dense accumulator of a worker (bloc_size^2 uint64) must fit in the L2 cache
+	 * and there must be enough columns of blocs to keep all the threads busy.
+	 * If the size of L2 is unknown, no size above DEFAULT_BLOC_SIZE is chosen.
+	 */
+	static uint16 selectBlocSize(size_t rowdim, size_t coldim, int nb_threads);
+
 	static uint32 loadF4Modulus(const char *fileName);
 
+	/**
+	 * Size in bytes of an entry of the values section of an F4 file: the values are
+	 * stored on 16 bits, except for moduli that do not fit on 16 bits where they take 32 bits.
+	 */
+	static inline uint32 F4ValueSize(uint32 mod) { return mod > 0xffff ? sizeof(uint32) : sizeof(uint16); }
+
 	template<class Ring>
 	static void loadF4Matrix(const Ring &R,
 			SparseMatrix<typename Ring::Element>& A, const char *fileName);
@@ -130,13 +154,20 @@ public:
 	static void loadF4Matrix__low_memory_syscall_no_checks(const Ring &R,
 			SparseMatrix<typename Ring::Element>& A, const char *fileName);
 
+	/**
+	 * Writes A to fileName in the F4 format read by loadF4Matrix: the values on F4ValueSize(modulus)
+	 * bytes, then the column indexes and the sizes of the rows
+	 */
+	template<typename Element>
+	static void writeF4Matrix(const SparseMatrix<Element>& A, uint32 modulus, const char *fileName);
+
 	template<typename Element>
 	static std::pair<uint64, double> getMatrixSizeAndDensity(
 			const SparseMatrix<Element>& A, bool exact);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static std::pair<uint64, double> getMatrixSizeAndDensity(
-			const SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			bool exact = false);
 
 	template <typename Element>
@@ -156,9 +187,9 @@ public:
 	static bool equal(const SparseMultilineMatrix<Element, Index>& A,
 			const SparseMultilineMatrix<Element, Index>& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void copyBlocToMultilineMatrix_DownTop_RightLeft(
-			const SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& inMatrix,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& inMatrix,
 			SparseMultilineMatrix<Element>& outMatrix);
 
 	template <typename Matrix>
@@ -166,34 +197,34 @@ public:
 
 private:
 	/*template <typename Element, typename Index>
-	 static void sparse_to_bloc_copyDownTopRightLeft(const SparseMatrix<Element>& A, SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B);*/
+	 static void sparse_to_bloc_copyDownTopRightLeft(const SparseMatrix<Element>& A, SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);*/
 	template<typename Element, typename SparseBlocMatrix_>
 	static void sparse_to_bloc_copyDownTopRightLeft(
 			const SparseMatrix<Element>& A, SparseBlocMatrix_& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void sparse_to_bloc_copyTopDowLeftRight(
 			const SparseMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B);
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void sparse_to_bloc_copyDownTopLeftRight(
 			const SparseMatrix<Element>& A,
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& B);
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void bloc_to_sparse_copyDownTopRightLeft(
-			const SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			SparseMatrix<Element>& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void bloc_to_sparse_copyTopDowLeftRight(
-			const SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+			const SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			SparseMatrix<Element>& B);
 
-	template<typename Element, typename Index>
+	template<typename Element, typename Index, uint16 BlocSize>
 	static void bloc_to_sparse_copyDownTopLeftRight(
-			SparseBlocMatrix<SparseMultilineBloc<Element, Index> >& A,
+			SparseBlocMatrix<SparseMultilineBloc<Element, Index, BlocSize> >& A,
 			SparseMatrix<Element>& B, bool destruct_original = false);
 
 	static void process_mem_usage(double& vm_usage, double& resident_set);
@@ -0,0 +1,145 @@
+/*
+ * memory-accounting.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Accounting of the memory held by the structures of the engine. The allocators of the rows
+ * (ArenaArray), of the arenas of the blocs and of the arrays of the indexers add and remove their
+ * bytes to a counter of live bytes, whose peak is followed with atomics; the phase profiler
+ * reads this peak for each phase. The scratch buffers of the workers and the dense copy of D are
+ * counted as they are allocated, under their own owner; after each phase, the engine records the
+ * bytes each sub-matrix holds (their memoryUsage ()), and checks the peak against the memory
+ * budget, if any. The input and output SparseMatrix, and the temporaries of LELA's Gauss-Jordan,
+ * are not counted.
+ */
+
+#ifndef MEMORY_ACCOUNTING_H_
+#define MEMORY_ACCOUNTING_H_
+
+#include <stdexcept>
+#include <string>
+
+#include "consts-macros.h"
+
+/// Thrown by the engine when a phase went past the memory budget
+class MemoryBudgetExceeded : public std::runtime_error
+{
+public:
+	MemoryBudgetExceeded (const std::string& what) : std::runtime_error (what) {}
+};
+
+class MemoryAccounting
+{
+public:
+
+	/// The structures whose bytes the engine records; the pivots, the columns right of them
+	/// and the non pivot rows of the second round are recorded as A, B, C and D
+	enum Owner
+	{
+		SUB_A = 0,
+		SUB_B,
+		SUB_C,
+		SUB_D,
+		MULTILINE_A,
+		MULTILINE_C,
+		MULTILINE_D,
+		INDEXER,
+		SCRATCH,		//counted by allocated () and freed () as they go, from here on
+		DENSE_D,
+		NB_OWNERS
+	};
+
+	static const char* ownerName (Owner owner);
+
+	/// Called by the allocators of the engine with the size of each block they allocate or free
+	static inline void allocated (size_t bytes)
+	{
+		Counters& c = _counters ();
+		const uint64 live = __sync_add_and_fetch (&c.live, bytes);
+		uint64 peak = c.peak;
+
+		while (live > peak && !__sync_bool_compare_and_swap (&c.peak, peak, live))
+			peak = c.peak;
+	}
+
+	static inline void freed (size_t bytes)
+	{
+		__sync_sub_and_fetch (&_counters ().live, bytes);
+	}
+
+	/// Same, for the blocks of owner (SCRATCH or DENSE_D), whose bytes are followed as well
+	static inline void allocated (size_t bytes, Owner owner)
+	{
+		Counters& c = _counters ();
+		const uint64 held = __sync_add_and_fetch (&c.owner_bytes[owner], bytes);
+		uint64 max = c.owner_max[owner];
+
+		while (held > max && !__sync_bool_compare_and_swap (&c.owner_max[owner], max, held))
+			max = c.owner_max[owner];
+
+		allocated (bytes);
+	}
+
+	static inline void freed (size_t bytes, Owner owner)
+	{
+		__sync_sub_and_fetch (&_counters ().owner_bytes[owner], bytes);
+		freed (bytes);
+	}
+
+	/// Bytes allocated and not freed, and their highest value since resetPeak ()
+	static uint64 liveBytes ()	{ return _counters ().live; }
+	static uint64 peakBytes ()	{ return _counters ().peak; }
+
+	/// Lowers the peak to the bytes live now, to follow the peak of the next phase
+	static void resetPeak ();
+
+	/// Sets the bytes held by owner, and keeps the highest value recorded since clear ()
+	static void record (Owner owner, uint64 bytes);
+
+	template <typename Matrix>
+	static void record (Owner owner, const Matrix& M) { record (owner, M.memoryUsage ()); }
+
+	/// Forgets the bytes recorded for the owners; the owners counted as they go keep their bytes
+	static void clear ();
+
+	/// Budget in bytes of the structures of the engine, 0 for none
+	static void setBudget (uint64 bytes);
+	static uint64 budget ();
+
+	/// Whether bytes more than the live ones stay within the budget
+	static bool fits (uint64 bytes);
+
+	/// Throws MemoryBudgetExceeded, naming step and the bytes of each owner, if the peak since
+	/// resetPeak () went past the budget
+	static void checkBudget (const char *step);
+
+	/// Reports the highest bytes recorded for each owner, and the peak of the live bytes
+	static void report ();
+
+private:
+	MemoryAccounting () {}
+	MemoryAccounting (const MemoryAccounting& other) {}
+
+	struct Counters
+	{
+		volatile uint64 live;
+		volatile uint64 peak;
+		uint64 budget;
+
+		volatile uint64 owner_bytes[NB_OWNERS];
+		volatile uint64 owner_max[NB_OWNERS];
+	};
+
+	static inline Counters& _counters ()
+	{
+		static Counters counters = { 0, 0, 0, {0}, {0} };
+		return counters;
+	}
+};
+
+#include "memory-accounting.C"
+
+#endif /* MEMORY_ACCOUNTING_H_ */
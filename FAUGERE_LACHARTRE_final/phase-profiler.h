@@ -0,0 +1,280 @@
+/*
+ * phase-profiler.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Always-on profile of the phases of the elimination: the wall time of each phase, and for each
+ * thread the cycles it spent in it and the flops, bytes touched and blocs it handled there.
+ * The engine brackets each phase with start () / stop (); a thread working in a phase enters it
+ * with a Scope, and the kernels then add their work with count (), which only touches thread
+ * local counters. These are added to the shared table, with atomics, when the Scope ends.
+ * The work of the level 2 kernels is also counted per kernel, layout of the rows and SIMD
+ * variant with countKernel (). Thread t of a phase, worker t of the pool or OpenMP thread t,
+ * has the row t of the table.
+ * The cycles are read from the time stamp counter. Each phase also keeps the peak of the bytes
+ * live in the structures of the engine while it ran, see MemoryAccounting.
+ */
+
+#ifndef PHASE_PROFILER_H_
+#define PHASE_PROFILER_H_
+
+#include <iostream>
+#include <time.h>
+
+#include "consts-macros.h"
+#include "types.h"
+#include "memory-accounting.h"
+#include "level2-ops-simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <x86intrin.h>
+#endif
+
+//threads beyond this share the last row of counters
+#define PROFILER_MAX_THREADS	256
+
+class PhaseProfiler
+{
+public:
+
+	enum Phase
+	{
+		INDEXER = 0,
+		REDUCE_C,
+		REDUCE_PIVOTS_BY_PIVOTS,
+		REDUCE_NON_PIVOTS_BY_PIVOTS,
+		ECHELONIZE,
+		RECONSTRUCT,
+		NB_PHASES
+	};
+
+	static const char* phaseName (Phase phase);
+
+	/// The level 2 kernels: reduction by a rectangular bloc (multiline rows of B), by a triangular
+	/// bloc (dense rows of accumulators), of dense rows by the multiline rows of A or D (reduceC
+	/// and the echelon form); then the same on the bit-packed GF(2) blocs and on the uint8 blocs
+	enum Kernel
+	{
+		RECTANGULAR = 0,
+		TRIANGULAR,
+		ROWS,
+		GF2_RECTANGULAR,
+		GF2_FOUR_RUSSIANS,
+		GF2_TRIANGULAR,
+		SMALL_PRIME_RECTANGULAR,
+		SMALL_PRIME_TRIANGULAR,
+		NB_KERNELS
+	};
+
+	/// Layout of the rows a kernel reads
+	enum Layout
+	{
+		SPARSE = 0,
+		DENSE,
+		BITMAP,
+		NB_LAYOUTS
+	};
+
+	enum { NB_VARIANTS = Level2SimdOps::AVX512 + 1 };
+
+	static const char* kernelName (Kernel kernel);
+	static const char* layoutName (Layout layout);
+
+	/// Variant of the Level2SimdOps kernels used on Element: the selected one on uint16, the
+	/// only ring they are written for, scalar otherwise
+	template <typename Element>
+	static inline Level2SimdOps::Variant simdVariant ()
+	{
+		return sizeof (Element) == sizeof (uint16) ? Level2SimdOps::selectedVariant () : Level2SimdOps::SCALAR;
+	}
+
+	/// Time stamp counter, or nanoseconds where there is none
+	static inline uint64 cycles ()
+	{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		return __rdtsc ();
+#else
+		struct timespec t;
+		clock_gettime (CLOCK_MONOTONIC, &t);
+		return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+	}
+
+	/// Adds work to the phase the calling thread is in; dropped outside of a Scope
+	static inline void count (uint64 flops, uint64 bytes, uint64 blocs)
+	{
+		Counters& c = _pending ();
+
+		c.flops += flops;
+		c.bytes += bytes;
+		c.blocs += blocs;
+	}
+
+	/// Adds one call of kernel on rows of layout, run with variant, to the kernel counters of the
+	/// calling thread; dropped outside of a Scope as count () is
+	static inline void countKernel (Kernel kernel, Layout layout, Level2SimdOps::Variant variant, uint64 flops, uint64 bytes)
+	{
+		KernelCounters& c = _pending_kernels ()[kernel][layout][variant];
+
+		++c.calls;
+		c.flops += flops;
+		c.bytes += bytes;
+	}
+
+	/// flops and bytes of a kernel reducing two rows of accumulators by nb_lines lines of v:
+	/// two flops per mul-add, the bytes of v plus the accumulators read and written. They are
+	/// added to flops and bytes, which the caller gives to count (), and to the counters of kernel
+	template <typename Element, typename Index, uint16 NbLines>
+	static inline void countKernel (Kernel kernel, Level2SimdOps::Variant variant, uint64& flops, uint64& bytes,
+			const MultiLineVector<Element, Index, NbLines>& v, const uint32 nb_lines)
+	{
+		const uint64 n = v.size ();
+
+		//an empty row has no index either; not a call to a dense kernel
+		if (n == 0)
+			return;
+
+		const Layout layout = v.is_bitmap () ? BITMAP : (!v.IndexData._index_vector.empty () ? SPARSE : DENSE);
+		const uint64 f = 4 * nb_lines * n;
+		const uint64 b = n * (NbLines * sizeof (Element) + (layout == SPARSE ? sizeof (Index) : 0)) + 2 * n * 2 * sizeof (uint64)
+				+ (layout == BITMAP ? v.IndexData._index_vector.size () * sizeof (Index) : 0);
+
+		flops += f;
+		bytes += b;
+		countKernel (kernel, layout, variant, f, b);
+	}
+
+	/// Same with nb_lines dense arrays of accumulators of width entries as the source
+	static inline void countKernel (Kernel kernel, Level2SimdOps::Variant variant, uint64& flops, uint64& bytes,
+			const uint32 width, const uint32 nb_lines)
+	{
+		const uint64 f = 4 * nb_lines * width;
+		const uint64 b = (uint64) width * (nb_lines + 2 * 2) * sizeof (uint64);
+
+		flops += f;
+		bytes += b;
+		countKernel (kernel, DENSE, variant, f, b);
+	}
+
+	/// The calling thread is in phase from the construction to the destruction; nested scopes of
+	/// the phase the thread is already in do nothing
+	class Scope
+	{
+	public:
+		Scope (Phase phase);
+		~Scope ();
+
+	private:
+		Scope (const Scope& other) {}
+
+		int _previous;
+		bool _nested;
+		uint64 _start;
+	};
+
+	/// Wall time of a phase, measured by the thread that runs the phases
+	static void start (Phase phase);
+	static void stop (Phase phase);
+
+	/// Clears all the counters; nb_threads is the number of threads the phases are run with
+	static void reset (uint32 nb_threads = 1);
+
+	/// Reports, for each phase run since reset (), its time, flops and bytes per second, then
+	/// the calls, flops and bytes of each kernel
+	static void report ();
+
+	/// Writes the counters since reset () as a JSON object
+	static void writeJSON (std::ostream& os);
+
+	/// Writes the JSON summary to fileName, "-" for the standard output; false if it can't be written
+	static bool writeJSON (const char *fileName);
+
+private:
+	PhaseProfiler () {}
+	PhaseProfiler (const PhaseProfiler& other) {}
+
+	struct Counters
+	{
+		uint64 cycles;
+		uint64 flops;
+		uint64 bytes;
+		uint64 blocs;
+	};
+
+	struct KernelCounters
+	{
+		uint64 calls;
+		uint64 flops;
+		uint64 bytes;
+	};
+
+	typedef KernelCounters KernelTable[NB_KERNELS][NB_LAYOUTS][NB_VARIANTS];
+
+	struct ThreadCounters
+	{
+		Counters phases[NB_PHASES];
+		KernelTable kernels;
+	} __attribute__((aligned(64)));
+
+	struct Table
+	{
+		ThreadCounters threads[PROFILER_MAX_THREADS];
+		uint64 wall_cycles[NB_PHASES];
+		uint64 wall_start[NB_PHASES];
+		uint64 runs[NB_PHASES];
+		uint64 peak_bytes[NB_PHASES];
+		uint32 nb_threads;		//as given to reset ()
+		volatile uint32 nb_slots;	//rows of the table used so far
+
+		//time stamp counter and clock at the last reset, to convert the cycles to seconds
+		uint64 reset_cycles;
+		double reset_time;
+	};
+
+	static Table& _table ();
+
+	/// Counters of the calling thread not yet added to the table
+	static inline Counters& _pending ()
+	{
+		static __thread Counters pending = { 0, 0, 0, 0 };
+		return pending;
+	}
+
+	/// Kernel counters of the calling thread not yet added to the table
+	static inline KernelTable& _pending_kernels ()
+	{
+		static __thread KernelTable pending;		//zero initialized
+		return pending;
+	}
+
+	/// Phase the calling thread is in, -1 outside of a Scope
+	static inline int& _phase ()
+	{
+		static __thread int phase = -1;
+		return phase;
+	}
+
+	/// Row of the table of the calling thread: its id in the pool or in the OpenMP team
+	static int _slot ();
+
+	/// Sum of the counters of all the threads in phase
+	static Counters _total (Phase phase);
+
+	/// Sum of the counters of all the threads for a kernel
+	static KernelCounters _total (Kernel kernel, Layout layout, Level2SimdOps::Variant variant);
+
+	/// Adds the pending counters of the calling thread to its current phase and clears them
+	static void _flush ();
+
+	static double _now ();
+
+	/// Time stamp counter ticks per second, measured from the last reset ()
+	static double _frequency ();
+};
+
+#include "phase-profiler.C"
+
+#endif /* PHASE_PROFILER_H_ */
@@ -0,0 +1,57 @@
+/*
+ * representation-cost-model.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Calibrates the thresholds of HybridRepresentation on the machine: the sparse, bitmap and
+ * dense two rows scal-mul-sub kernels of Level2Ops are timed on multiline rows of increasing
+ * density; the threshold is the density from which the dense layout is the cheapest, and the
+ * bitmap threshold the one from which the bitmap layout is cheaper than the sparse one.
+ * The measures can be saved to a profile file and loaded by the next runs.
+ */
+
+#ifndef REPRESENTATION_COST_MODEL_H_
+#define REPRESENTATION_COST_MODEL_H_
+
+#include "consts-macros.h"
+#include "hybrid-representation.h"
+#include "level2-ops.h"
+
+class RepresentationCostModel
+{
+public:
+	enum Layout { SPARSE, DENSE, BITMAP };
+
+	/// Times the kernels and returns the density from which dense rows are the cheapest
+	static float measureThreshold ();
+
+	/// Times the kernels and returns the density from which bitmap rows are cheaper than sparse
+	/// ones, dense_threshold if they never are below it
+	static float measureBitmapThreshold (float dense_threshold);
+
+	/// Reads the thresholds from a profile written by saveProfile; false if it can't be read. A
+	/// profile without bitmap threshold gives bitmap_threshold = threshold, no bitmap rows
+	static bool loadProfile (const char *fileName, float& threshold, float& bitmap_threshold);
+
+	static bool saveProfile (const char *fileName, float threshold, float bitmap_threshold);
+
+	/**
+	 * Sets the thresholds of HybridRepresentation from the profile fileName; if the file doesn't
+	 * exist, the thresholds are measured and saved to it. Returns the threshold used
+	 */
+	static float init (const char *fileName);
+
+private:
+	RepresentationCostModel () {}
+	RepresentationCostModel (const RepresentationCostModel& other) {}
+
+	/// Best time of a few runs of the two rows kernel of layout on a row with nb_entries entries
+	static double timeKernel (uint32 nb_entries, Layout layout);
+};
+
+#include "representation-cost-model.C"
+
+#endif /* REPRESENTATION_COST_MODEL_H_ */
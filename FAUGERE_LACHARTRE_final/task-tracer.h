@@ -0,0 +1,117 @@
+/*
+ * task-tracer.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Timeline of the tasks of the parallel phases: each worker records, for every task it runs,
+ * when it began and ended, the bloc column and rows it covered and the time it spent waiting
+ * (on other blocs or on a lock) inside it. The events are kept in a buffer per thread and written
+ * in the Chrome trace event format, which chrome://tracing and Perfetto open.
+ * Tracing is off unless enable () is called; the workers then only test a flag per task.
+ */
+
+#ifndef TASK_TRACER_H_
+#define TASK_TRACER_H_
+
+#include <vector>
+#include <pthread.h>
+
+#include "types.h"
+#include "phase-profiler.h"
+
+class TaskTracer
+{
+public:
+
+	/// Starts recording the tasks; the timestamps of the trace are relative to this call
+	static void enable ();
+
+	static inline bool enabled ()
+	{
+		return _enabled ();
+	}
+
+	/// Time stamp counter if tracing is on, 0 otherwise
+	static inline uint64 now ()
+	{
+		return _enabled () ? PhaseProfiler::cycles () : 0;
+	}
+
+	/**
+	 * Records the task name of the calling thread, from begin (see now ()) until now; column is
+	 * the bloc column, [row_from, row_to] the rows (of blocs or multilines) it covered, -1 when
+	 * it does not apply, and wait_cycles the part of it spent waiting.
+	 */
+	static inline void record (const char *name, uint64 begin, int64 column, int64 row_from, int64 row_to, uint64 wait_cycles = 0)
+	{
+		if (_enabled ())
+			_record (name, begin, column, row_from, row_to, wait_cycles);
+	}
+
+	/// Writes the events recorded so far as a JSON trace
+	static void writeJSON (std::ostream& os);
+
+	/// Writes the events recorded so far to fileName, "-" for the standard output; false if it can't be written
+	static bool writeJSON (const char *fileName);
+
+	/// Drops the events recorded so far
+	static void clear ();
+
+private:
+	TaskTracer () {}
+	TaskTracer (const TaskTracer& other) {}
+
+	struct Event
+	{
+		const char *name;
+		uint64 begin;
+		uint64 end;
+		uint64 wait;
+		int64 column;
+		int64 row_from;
+		int64 row_to;
+	};
+
+	/// Events of one thread
+	struct Buffer
+	{
+		uint32 tid;
+		std::vector<Event> events;
+	};
+
+	static inline bool& _enabled ()
+	{
+		static bool enabled = false;
+		return enabled;
+	}
+
+	static void _record (const char *name, uint64 begin, int64 column, int64 row_from, int64 row_to, uint64 wait_cycles);
+
+	/// Buffer of the calling thread, created and registered on its first event
+	static Buffer& _buffer ();
+
+	static std::vector<Buffer *>& _buffers ();
+
+	/// Time stamp counter and clock when tracing was enabled, to convert the cycles to microseconds
+	struct Origin
+	{
+		uint64 cycles;
+		double time;
+	};
+
+	static Origin& _origin ();
+
+	/// Protects the list of buffers, and the buffers while they are cleared or written
+	static inline pthread_mutex_t& _lock ()
+	{
+		static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+		return lock;
+	}
+};
+
+#include "task-tracer.C"
+
+#endif /* TASK_TRACER_H_ */
@@ -12,23 +12,30 @@
 #include <iostream>
 #include <vector>
 #include <assert.h>
+#include <cstdlib>
 
 #include "consts-macros.h"
 #include "Allocator.h"
+#include "arena-array.h"
+#include "memory-accounting.h"
+#include "hybrid-representation.h"
 #include "lela/vector/sparse.h"
 
 using namespace LELA;
 
 
 
-template <typename Element, typename Index = uint16>
+/**
+ * NbLines rows stored together: one index per column where one of the rows is non zero, and the
+ * NbLines values of that column next to each other. The elimination works on multilines of
+ * NB_ROWS_PER_MULTILINE rows; the __N_rows__ kernels of Level2Ops also take 4 and 8
+ */
+template <typename Element, typename Index = uint16, uint16 NbLines = NB_ROWS_PER_MULTILINE>
 class MultiLineVector {
 public:
 
 	MultiLineVector()
 	{
-		IndexData._index_vector = std::vector<Index, aligned_allocator<Index, 16> > ();
-		ValuesData._data = std::vector<Element, aligned_allocator<Element, 16> > ();
 	}
 
 	~MultiLineVector()
@@ -48,15 +55,15 @@ public:
 //			ValuesData._data = source.ValuesData._data;
 //	}
 
-	inline void		reserve		(size_t sz)		{ IndexData._index_vector.reserve (sz); ValuesData._data.reserve (sz*NB_ROWS_PER_MULTILINE); }
+	inline void		reserve		(size_t sz)		{ IndexData._index_vector.reserve (sz); ValuesData._data.reserve (sz*NbLines); }
 
 	inline bool		empty		()	const		{ return ValuesData._data.empty (); }
 
 	inline size_t size() const
 	{
-		return ValuesData._data.size() / NB_ROWS_PER_MULTILINE;
+		return ValuesData._data.size() / NbLines;
 	}
-	inline uint16  nb_lines	()	const		{ return NB_ROWS_PER_MULTILINE; }
+	inline uint16  nb_lines	()	const		{ return NbLines; }
 
 	inline void clear()
 	{
@@ -66,9 +73,9 @@ public:
 
 	inline Element	at			(uint16 line_index, size_t n)	const
 	{
-		if (line_index >= NB_ROWS_PER_MULTILINE)
+		if (line_index >= NbLines)
 		{
-			std::cerr << "std::out_of_range (line_index) " << line_index << "[_bloc_height = " << NB_ROWS_PER_MULTILINE << "]" <<std::endl;
+			std::cerr << "std::out_of_range (line_index) " << line_index << "[_bloc_height = " << NbLines << "]" <<std::endl;
 			throw std::out_of_range ("line_index");
 		}
 
@@ -78,24 +85,34 @@ public:
 			throw std::out_of_range ("n");
 		}
 		else
-			return ValuesData._data[line_index + NB_ROWS_PER_MULTILINE * n];
+			return ValuesData._data[line_index + NbLines * n];
 	}
 
 	inline Element	at_unchecked(uint16 line_index, size_t n)	const
 	{
-		return ValuesData._data[line_index + NB_ROWS_PER_MULTILINE * n];
+		return ValuesData._data[line_index + NbLines * n];
 	}
 
 	inline void push_back(uint32 index, Element e1, Element e2)
 	{
+		static_assert (NbLines == 2, "push_back (index, e1, e2) needs a multiline of 2 rows");
+
 		IndexData.push_back(index);
 		ValuesData.push_back(e1);
 		ValuesData.push_back(e2);
 	}
 
+	/// Appends the column index with the NbLines values of values
+	inline void push_back(uint32 index, const Element *values)
+	{
+		IndexData.push_back(index);
+		for(uint16 l = 0; l < NbLines; ++l)
+			ValuesData.push_back(values[l]);
+	}
+
 	struct IndexData
 	{
-		typedef typename std::vector<Index>::iterator iterator;
+		typedef typename ArenaArray<Index, 16>::iterator iterator;
 
 		iterator	begin ()		{ return _index_vector.begin (); }
 		iterator	end   ()		{ return _index_vector.end (); }
@@ -105,7 +122,7 @@ public:
 
 		inline void		push_back (Index i)	{ _index_vector.push_back (i); }
 
-		std::vector<Index, aligned_allocator<Index, 16> >		_index_vector;
+		ArenaArray<Index, 16>		_index_vector;
 		
 		Index* 	getStartingPointer ()	{ return &(_index_vector[0]); }
 		const Index* 	getStartingPointer ()	const	{ return &(_index_vector[0]); }
@@ -117,7 +134,7 @@ public:
 
 	struct ValuesData
 	{
-		typedef typename std::vector<Element>::iterator iterator;
+		typedef typename ArenaArray<Element, 16>::iterator iterator;
 
 		iterator	begin ()		{ return this->_data.begin (); }
 		iterator	end   ()		{ return this->_data.end (); }
@@ -127,7 +144,7 @@ public:
 
 		inline void		push_back (Element e)	{ this->_data.push_back (e); }
 
-		std::vector<Element, aligned_allocator<Element, 16> >	_data;
+		ArenaArray<Element, 16>	_data;
 		
 		Element*		getStartingPointer ()	{ return &(_data[0]); }
 		const Element*		getStartingPointer ()	const	{ return &(_data[0])	; }
@@ -137,25 +154,93 @@ public:
 
 	} ValuesData;
 
-	void swap(MultiLineVector<Element, Index>& other)
+	void swap(MultiLineVector<Element, Index, NbLines>& other)
 	{
-		std::swap(this->IndexData._index_vector, other.IndexData._index_vector);
-		std::swap(this->ValuesData._data, other.ValuesData._data);
+		this->IndexData._index_vector.swap(other.IndexData._index_vector);
+		this->ValuesData._data.swap(other.ValuesData._data);
 	}
 
 	static inline float get_HYBRID_REPRESENTATION_THRESHOLD ()
 	{
-		return (float) HYBRID_REPRESENTATION_THRESHOLD;
+		return HybridRepresentation::threshold ();
 	}
 
-	inline bool is_sparse () const
+	inline bool is_sparse (const uint32 size) const
 	{
-		return ValuesData._data.size() < DEFAULT_BLOC_WIDTH * 2;
+		return ValuesData._data.size() < size * NbLines;
 	}
-	
-	inline bool is_sparse (const uint32 size) const
+
+	/*
+	 * Bitmap layout, for the rows of medium density of a bloc of at most 512 columns: IndexData
+	 * holds bitmapMark (), then one bit per column of the bloc, set where the row has an entry
+	 * (column c is bit c % bits of word c / bits, bits the bits of an Index), and ValuesData the
+	 * NbLines values of each entry in the order of the columns, as in the sparse layout. Only the
+	 * kernels of Level2Ops that read the vect rows know this layout, see HybridRepresentation.
+	 */
+
+	/// Never the first index of a sparse row, the columns of a bloc being below the largest Index
+	static inline Index bitmapMark () { return (Index) ~(Index) 0; }
+
+	inline bool is_bitmap () const
 	{
-		return ValuesData._data.size() < size * 2;
+		return !IndexData._index_vector.empty () && IndexData[0] == bitmapMark ();
+	}
+
+	/// Lays out a sparse row of a bloc of width columns as a bitmap
+	inline void to_bitmap (const uint32 width)
+	{
+		const uint32 bits = 8 * sizeof (Index);
+		const uint32 nb_words = (width + bits - 1) / bits;
+		Index words[1 + 512 / 8];
+
+		memset (words, 0, (1 + nb_words) * sizeof (Index));
+		words[0] = bitmapMark ();
+
+		bool ascending = true;
+
+		for (uint32 i = 0; i < IndexData._index_vector.size (); ++i)
+		{
+			words[1 + IndexData[i] / bits] |= (Index) (1U << (IndexData[i] % bits));
+			ascending = ascending && (i == 0 || IndexData[i - 1] < IndexData[i]);
+		}
+
+		//the values follow the columns of the bitmap; the rows copied right to left are reversed
+		if (!ascending)
+		{
+			uint16 rank[512];
+			Element values[512 * NbLines];
+			uint32 n = 0;
+
+			for (uint32 w = 0; w < nb_words; ++w)
+				for (uint32 word = words[1 + w]; word != 0; word &= word - 1)
+					rank[w * bits + __builtin_ctz (word)] = n++;
+
+			for (uint32 i = 0; i < n; ++i)
+				for (uint16 l = 0; l < NbLines; ++l)
+					values[rank[IndexData[i]] * NbLines + l] = ValuesData[i * NbLines + l];
+
+			ValuesData._data.assign (values, n * NbLines);
+		}
+
+		IndexData._index_vector.assign (words, 1 + nb_words);
+	}
+
+	/// Lays out a row of a bloc of width columns in the bitmap layout back as a sparse row
+	inline void from_bitmap (const uint32 width)
+	{
+		const uint32 bits = 8 * sizeof (Index);
+		const uint32 nb_words = (width + bits - 1) / bits;
+		Index words[1 + 512 / 8];
+		Index indexes[512];
+		uint32 n = 0;
+
+		memcpy (words, IndexData.getStartingPointer (), (1 + nb_words) * sizeof (Index));
+
+		for (uint32 w = 0; w < nb_words; ++w)
+			for (uint32 word = words[1 + w]; word != 0; word &= word - 1)
+				indexes[n++] = (Index) (w * bits + __builtin_ctz (word));
+
+		IndexData._index_vector.assign (indexes, n);
 	}
 
 	inline void free ()
@@ -163,17 +248,20 @@ public:
 		//this->IndexData._index_vector.clear ();
 		//this->ValuesData._data.clear ();
 
-		std::vector<Index, aligned_allocator<Index, 16> > _idx_tmp;
-		std::vector<Element, aligned_allocator<Element, 16> > _elt_tmp;
+		this->IndexData._index_vector.release ();
+		this->ValuesData._data.release ();
+	}
 
-		this->IndexData._index_vector.swap(_idx_tmp);
-		this->ValuesData._data.swap(_elt_tmp);
+	/// Bytes of the storage the row owns, not counting a slice of the arena of its bloc
+	inline size_t memoryUsage () const
+	{
+		return IndexData._index_vector.ownedBytes () + ValuesData._data.ownedBytes ();
 	}
 
-	bool equal (MultiLineVector<Element, Index> other, const size_t SIZE_DENSE_VECTOR) const
+	bool equal (MultiLineVector<Element, Index, NbLines> other, const size_t SIZE_DENSE_VECTOR) const
 	{
-		MultiLineVector<Element, Index> _tmp_sparse;
-		Element e1, e2;
+		MultiLineVector<Element, Index, NbLines> _tmp_sparse;
+		uint16 l;
 
 		if(this->is_sparse(SIZE_DENSE_VECTOR) && other.is_sparse(SIZE_DENSE_VECTOR))
 		{
@@ -190,14 +278,15 @@ public:
 		{
 			for(uint32 i=0; i<other.size(); ++i)
 			{
-				e1 = other.at_unchecked(0, i);
-				e2 = other.at_unchecked(1, i);
+				for(l = 0; l < NbLines; ++l)
+					if(other.at_unchecked(l, i) != 0)
+						break;
 
-				if(e1 != 0 || e2 != 0)
+				if(l < NbLines)
 				{
 					_tmp_sparse.IndexData.push_back(i);
-					_tmp_sparse.ValuesData.push_back(e1);
-					_tmp_sparse.ValuesData.push_back(e2);
+					for(l = 0; l < NbLines; ++l)
+						_tmp_sparse.ValuesData.push_back(other.at_unchecked(l, i));
 				}
 			}
 
@@ -214,14 +303,15 @@ public:
 		{
 			for(uint32 i=0; i<this->size(); ++i)
 			{
-				e1 = this->at_unchecked(0, i);
-				e2 = this->at_unchecked(1, i);
+				for(l = 0; l < NbLines; ++l)
+					if(this->at_unchecked(l, i) != 0)
+						break;
 
-				if(e1 != 0 || e2 != 0)
+				if(l < NbLines)
 				{
 					_tmp_sparse.IndexData.push_back(i);
-					_tmp_sparse.ValuesData.push_back(e1);
-					_tmp_sparse.ValuesData.push_back(e2);
+					for(l = 0; l < NbLines; ++l)
+						_tmp_sparse.ValuesData.push_back(this->at_unchecked(l, i));
 				}
 			}
 
@@ -247,8 +337,7 @@ public:
 		return false;
 	}
 private:
-	//To save space, we hard code these values into the multiline vector.
-	//Number of rows is always 2
+	//To save space, the number of rows is a template parameter
 	//uint16					_bloc_height;			//number of lines per bloc
 
 };
@@ -256,13 +345,23 @@ private:
 
 
 
-template <typename Element, typename Index = uint16>
+/**
+ * The bloc size is a template parameter so that the kernels working on a bloc
+ * get its dimensions as compile-time constants; the sizes supported by the drivers
+ * are instantiated up-front (see SUPPORTED_BLOC_SIZES in consts-macros.h)
+ */
+template <typename Element, typename Index = uint16, uint16 BlocSize = DEFAULT_BLOC_SIZE>
 class SparseMultilineBloc {
 
 public:
 	typedef Index IndexType;
 	typedef Element ElementType;
 
+	enum { BLOC_HEIGHT = BlocSize, BLOC_WIDTH = BlocSize };
+
+	static_assert (BlocSize % UNROLL_STEP__64 == 0, "bloc size must be a multiple of UNROLL_STEP__64");
+	static_assert ((uint32) BlocSize <= (uint32) (Index) ~0, "Index type too small for the bloc size");
+
 	typedef MultiLineVector<Element, Index> Row;
 	typedef const Row ConstRow;
 	typedef std::vector<Row> Rep;
@@ -270,7 +369,7 @@ public:
 	typedef typename Rep::iterator RowIterator;
 	typedef typename Rep::const_iterator ConstRowIterator;
 
-	SparseMultilineBloc()
+	SparseMultilineBloc() : _arena (NULL), _arena_bytes (0)
 	{
 		//_A = Rep(_bloc_height);
 	}
@@ -280,21 +379,33 @@ public:
 		this->free ();
 	}
 
-	SparseMultilineBloc (uint16 bloc_height, uint16 bloc_width)
+	SparseMultilineBloc (uint16 bloc_height, uint16 bloc_width) : _arena (NULL), _arena_bytes (0)
 	{
 		_A = Rep (bloc_height/NB_ROWS_PER_MULTILINE);
 	}
 
-	SparseMultilineBloc (uint16 bloc_height)
+	SparseMultilineBloc (uint16 bloc_height) : _arena (NULL), _arena_bytes (0)
 	{
 		_A = Rep (bloc_height/NB_ROWS_PER_MULTILINE);
 	}
 
 
-	SparseMultilineBloc(const SparseMultilineBloc<Element, Index>& other) :
-				_A (other._A)
+	/// The rows of the copy have their own storage, the arena of other is not shared
+	SparseMultilineBloc(const SparseMultilineBloc<Element, Index, BlocSize>& other) :
+				_A (other._A), _arena (NULL), _arena_bytes (0)
+	{
+
+	}
+
+	SparseMultilineBloc& operator= (const SparseMultilineBloc<Element, Index, BlocSize>& other)
 	{
+		if(this != &other)
+		{
+			this->free ();
+			_A = other._A;
+		}
 
+		return *this;
 	}
 
 	void	init	(uint16 height, uint16 width)
@@ -305,11 +416,58 @@ public:
 		if(width < 1)
 			throw std::invalid_argument ("bloc_width");
 
+		this->free ();
 		_A = Rep (height/NB_ROWS_PER_MULTILINE);
 	}
 
-	uint16	bloc_height	()	const	{ return DEFAULT_BLOC_HEIGHT / NB_ROWS_PER_MULTILINE; }
-	uint16	bloc_width	()	const	{ return DEFAULT_BLOC_WIDTH; }
+	/**
+	 * Empties the rows and lays them out in one slab aligned on a cache line, like a CSR bloc:
+	 * the row i gets room for nb_indexes[i] indexes and nb_values[i] values, all the indexes of
+	 * the bloc first then all the values. The rows keep their usual interface; one pushing past
+	 * its room moves to storage of its own. The previous arena of the bloc is freed
+	 */
+	void	allocateArena	(const uint32 *nb_indexes, const uint32 *nb_values)
+	{
+		//each array starts on 16 bytes, like the ones of aligned_allocator
+		const uint32 idx_align = 16 / sizeof (Index);
+		const uint32 val_align = 16 / sizeof (Element);
+		size_t total_indexes = 0, total_values = 0;
+
+		for(uint32 i=0; i<_A.size (); ++i)
+		{
+			total_indexes += roundUp (nb_indexes[i], idx_align);
+			total_values += roundUp (nb_values[i], val_align);
+		}
+
+		void *arena = NULL;
+		const size_t values_offset = total_indexes * sizeof (Index);
+		const size_t arena_bytes = values_offset + total_values * sizeof (Element);
+
+		if(arena_bytes > 0 && posix_memalign (&arena, 64, arena_bytes) != 0)
+			throw std::bad_alloc ();
+
+		MemoryAccounting::allocated (arena_bytes);
+
+		Index *idx = (Index *) arena;
+		Element *val = (Element *) ((uint8 *) arena + values_offset);
+
+		for(uint32 i=0; i<_A.size (); ++i)
+		{
+			_A[i].IndexData._index_vector.bind (idx, nb_indexes[i]);
+			_A[i].ValuesData._data.bind (val, nb_values[i]);
+
+			idx += roundUp (nb_indexes[i], idx_align);
+			val += roundUp (nb_values[i], val_align);
+		}
+
+		MemoryAccounting::freed (_arena_bytes);
+		std::free (_arena);
+		_arena = arena;
+		_arena_bytes = arena_bytes;
+	}
+
+	uint16	bloc_height	()	const	{ return BlocSize / NB_ROWS_PER_MULTILINE; }
+	uint16	bloc_width	()	const	{ return BlocSize; }
 
 	RowIterator      rowBegin ()			{ return _A.begin (); }
 	ConstRowIterator rowBegin ()	const	{ return _A.begin (); }
@@ -325,7 +483,7 @@ public:
 
 	static inline float get_HYBRID_REPRESENTATION_THRESHOLD ()
 	{
-		return (float) HYBRID_REPRESENTATION_THRESHOLD;
+		return HybridRepresentation::threshold ();
 	}
 
 	inline void free (bool deep = false)
@@ -340,14 +498,35 @@ public:
 
 		Rep tmp;
 		_A.swap(tmp);
+
+		MemoryAccounting::freed (_arena_bytes);
+		std::free (_arena);
+		_arena = NULL;
+		_arena_bytes = 0;
+	}
+
+	/// Bytes of the bloc: its rows, their own storage and its arena
+	size_t	memoryUsage	()	const
+	{
+		size_t bytes = sizeof (*this) + _A.capacity () * sizeof (Row) + _arena_bytes;
+
+		for(uint32 i=0; i<_A.size (); ++i)
+			bytes += _A[i].memoryUsage ();
+
+		return bytes;
 	}
 
 private:
+	static inline uint32 roundUp (uint32 n, uint32 multiple) { return (n + multiple - 1) / multiple * multiple; }
+
 	//To save space, we hard code these values into the multiline vector.
 	//Number of rows is always 2
 	//uint16					_bloc_height;			//number of lines per bloc
 	//uint16					_bloc_width;
 	Rep						_A;
+	/// Storage of the rows laid out by allocateArena, NULL if they all have their own
+	void					*_arena;
+	size_t					_arena_bytes;
 };
 
 
@@ -398,7 +577,7 @@ public:
 	}
 
 
-	SparseMultilineBloc(const SparseMultilineBloc<Element, Index>& other) :
+	SparseMultilineBloc(const SparseMultilineBloc<Element, Index, BlocSize>& other) :
 				_bloc_height (other._bloc_height),
 				_bloc_width (other._bloc_width),
 				_A (other._A)
@@ -437,7 +616,7 @@ public:
 
 	static inline float get_HYBRID_REPRESENTATION_THRESHOLD ()
 	{
-		return (float) HYBRID_REPRESENTATION_THRESHOLD;
+		return HybridRepresentation::threshold ();
 	}
 
 	inline void free (bool deep = false)
@@ -582,7 +761,7 @@ public:
 
 	static inline float get_HYBRID_REPRESENTATION_THRESHOLD ()
 	{
-		return (float) HYBRID_REPRESENTATION_THRESHOLD;
+		return HybridRepresentation::threshold ();
 	}
 
 	inline bool is_sparse () const
@@ -723,8 +902,8 @@ public:
 			acceptRowsHybrid (true),
 			_m(0),
 			_n(0),
-			_bloc_height(DEFAULT_BLOC_HEIGHT),
-			_bloc_width(DEFAULT_BLOC_WIDTH) {}
+			_bloc_height(BlocType_::BLOC_HEIGHT),
+			_bloc_width(BlocType_::BLOC_WIDTH) {}
 
 
 	SparseBlocMatrix (const SparseBlocMatrix<BlocType>& other) :
@@ -746,8 +925,8 @@ public:
 	SparseBlocMatrix (size_t n, size_t m,
 					  BlocArrangement blocs_arrangement = ArrangementTopDown_LeftRight,
 					  bool fill_with_empty_blocs = false,
-					  uint16 bloc_height=DEFAULT_BLOC_HEIGHT,
-					  uint16 bloc_width=DEFAULT_BLOC_WIDTH) :
+					  uint16 bloc_height=BlocType_::BLOC_HEIGHT,
+					  uint16 bloc_width=BlocType_::BLOC_WIDTH) :
 						  	  	blocArrangement (blocs_arrangement),
 								_m (m),
 								_n (n),
@@ -821,7 +1000,7 @@ public:
 
 	static inline float get_HYBRID_REPRESENTATION_THRESHOLD ()
 	{
-		return (float) HYBRID_REPRESENTATION_THRESHOLD;
+		return HybridRepresentation::threshold ();
 	}
 
 	void free (bool deep = false)
@@ -843,6 +1022,21 @@ public:
 		FirstBlocsColumIndexes.free ();
 	}
 
+	/// Bytes of the blocs of the matrix
+	size_t memoryUsage () const
+	{
+		size_t bytes = _A.capacity () * sizeof (Row);
+
+		for(uint32 i=0; i<_A.size (); ++i)
+		{
+			bytes += (_A[i].capacity () - _A[i].size ()) * sizeof (BlocType);
+			for(uint32 j=0; j<_A[i].size (); ++j)
+				bytes += _A[i][j].memoryUsage ();
+		}
+
+		return bytes;
+	}
+
 private:
 	Rep					_A;
 	//std::vector<uint32>	_blocs_start_colum_indexes;
@@ -942,6 +1136,17 @@ public:
 		_A.swap(tmp);
 	}
 
+	/// Bytes of the multilines of the matrix
+	size_t memoryUsage () const
+	{
+		size_t bytes = _A.capacity () * sizeof (Row);
+
+		for(uint32 i=0; i<_A.size (); ++i)
+			bytes += _A[i].memoryUsage ();
+
+		return bytes;
+	}
+
 private:
 	Rep		_A;
 	size_t		_m;
@@ -0,0 +1,61 @@
+/*
+ * work-stealing-scheduler.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Distributes a fixed set of independent tasks 0..nb_tasks-1 among threads.
+ * Each thread owns a deque holding a contiguous range of task ids, initially an equal
+ * share of the tasks; it pops tasks from the front of its own range and, once empty,
+ * steals the back half of the range of another thread. Every deque has its own lock,
+ * so threads only contend when they steal.
+ */
+
+#ifndef WORK_STEALING_SCHEDULER_H_
+#define WORK_STEALING_SCHEDULER_H_
+
+#include <pthread.h>
+
+#include "consts-macros.h"
+
+class WorkStealingScheduler
+{
+public:
+
+	WorkStealingScheduler (uint32 nb_threads, uint32 nb_tasks);
+	~WorkStealingScheduler ();
+
+	/// Gets the next task for thread_id; returns false once all the tasks have been handed out
+	inline bool nextTask (uint32 thread_id, uint32& task);
+
+	uint32 nbThreads () const { return _nb_threads; }
+	uint32 nbTasks () const { return _nb_tasks; }
+
+	/// Number of successful steals, for reporting
+	uint32 nbSteals () const;
+
+private:
+	WorkStealingScheduler (const WorkStealingScheduler& other) {}
+
+	/// The deque of a thread: the tasks [begin, end) not yet handed out, alone on its cache line
+	struct TaskRange
+	{
+		uint32 begin;
+		uint32 end;
+		uint32 nb_steals;
+		uint32 seed;
+		pthread_spinlock_t lock;
+	} __attribute__((aligned(64)));
+
+	bool steal (uint32 thread_id, uint32& task);
+
+	uint32 _nb_threads;
+	uint32 _nb_tasks;
+	TaskRange *_ranges;
+};
+
+#include "work-stealing-scheduler.C"
+
+#endif /* WORK_STEALING_SCHEDULER_H_ */
@@ -0,0 +1,105 @@
+/*
+ * worker-pool.h
+ * Copyright 2026 The LELA team
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: The LELA team
+ *
+ * ---------------------------------------
+ * Set of threads created once and reused by all the parallel phases. A run hands the same
+ * routine to the first nb_threads workers, each with its own parameter, and returns once
+ * they have all returned, like a pthread_create/pthread_join loop would.
+ * Each worker owns a few scratch buffers aligned on a cache line, kept from one run to the
+ * next, which replace the dense arrays the routines used to allocate and free at every phase.
+ */
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <pthread.h>
+#include <vector>
+
+#include "consts-macros.h"
+
+class WorkerPool
+{
+public:
+	typedef void* (*Routine) (void*);
+
+	enum { NB_SCRATCH_SLOTS = 4 };
+
+	/// The pool shared by all the parallel phases, grown to at least nb_threads workers
+	static WorkerPool& instance (uint32 nb_threads);
+
+	/// Runs routine(args[t]) on the workers t = 0..nb_threads-1 and waits for all of them.
+	/// Must not be called from within a worker
+	void run (Routine routine, void** args, uint32 nb_threads);
+
+	/// Runs routine on nb_threads workers, the worker t gets &params[t]
+	template <typename T>
+	void runEach (Routine routine, T* params, uint32 nb_threads);
+
+	/// Runs routine on nb_threads workers, all getting params
+	template <typename T>
+	void runAll (Routine routine, T* params, uint32 nb_threads);
+
+	uint32 nbWorkers () const { return _workers.size (); }
+
+	/// Id of the calling worker, -1 if the caller is not a worker of the pool
+	static int workerId ();
+
+	/// Scratch buffer number slot of the calling worker, of at least size bytes and aligned on a
+	/// cache line. Its content is undefined; it is kept for the next runs and only grows
+	static void* scratch (uint32 slot, size_t size);
+
+	/// Points rows[0..nb_rows-1] to rows of width uint64, each starting on a cache line,
+	/// carved out of the scratch buffer number slot
+	static void scratchRows (uint32 slot, uint64** rows, uint32 nb_rows, uint32 width);
+
+private:
+	WorkerPool ();
+	~WorkerPool ();
+	WorkerPool (const WorkerPool& other) {}
+
+	struct Worker
+	{
+		WorkerPool *pool;
+		uint32 id;
+		uint64 generation;		//last run seen by the worker
+		pthread_t thread;
+
+		void *scratch[NB_SCRATCH_SLOTS];
+		size_t scratch_size[NB_SCRATCH_SLOTS];
+	} __attribute__((aligned(64)));
+
+	static void* workerMain (void* p_worker);
+
+	/// The worker running on the calling thread, NULL outside the pool
+	static inline Worker*& _current ()
+	{
+		static __thread Worker *current = NULL;
+		return current;
+	}
+
+	/// Creates workers up to nb_threads, called with _run_lock held
+	void grow (uint32 nb_threads);
+
+	std::vector<Worker*> _workers;
+
+	pthread_mutex_t _run_lock;		//one run at a time
+	pthread_mutex_t _lock;
+	pthread_cond_t _work_cond;
+	pthread_cond_t _done_cond;
+
+	//the current run, protected by _lock
+	Routine _routine;
+	void **_args;
+	uint32 _nb_active;
+	uint32 _nb_pending;
+	uint64 _generation;
+	bool _quit;
+};
+
+#include "worker-pool.C"
+
+#endif /* WORKER_POOL_H_ */
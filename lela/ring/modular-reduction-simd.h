@@ -0,0 +1,130 @@
+/* lela/ring/modular-reduction-simd.h
+ * Copyright 2026 The LELA team
+ *
+ * Written by the LELA team
+ *
+ * AVX2 and AVX-512 versions of BarrettReduction::reduce (arr, n)
+ *
+ * ------------------------------------
+ *
+ * This file is part of LELA, licensed under the GNU General Public
+ * License version 3. See COPYING for more information.
+ */
+
+#ifndef __LELA_RING_MODULAR_REDUCTION_SIMD_H
+#define __LELA_RING_MODULAR_REDUCTION_SIMD_H
+
+#include "lela/ring/modular-reduction.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__SIZEOF_INT128__)
+#  define __LELA_HAVE_BARRETT_SIMD
+#  include <immintrin.h>
+#endif
+
+#ifdef __LELA_HAVE_BARRETT_SIMD
+
+namespace LELA
+{
+
+/** Reduce the n words of arr in place modulo B.modulus (), four words
+ * at a time
+ *
+ * The functions are compiled with per-function target attributes, so
+ * the caller must check that the CPU supports them.
+ *
+ * \ingroup ring
+ */
+inline void barrettReduce__avx2 (const BarrettReduction &B, uint64 *arr, size_t n) __attribute__((target("avx2")));
+
+/// Same as barrettReduce__avx2, eight words at a time
+inline void barrettReduce__avx512 (const BarrettReduction &B, uint64 *arr, size_t n) __attribute__((target("avx512f")));
+
+// The high word of the 128-bit product a * inverse is assembled from the
+// four 32x32-bit products, since there is no 64-bit multiply-high
+
+inline void barrettReduce__avx2 (const BarrettReduction &B, uint64 *arr, size_t n)
+{
+	const __m256i inv_lo = _mm256_set1_epi64x (B.inverse () & 0xffffffffULL);
+	const __m256i inv_hi = _mm256_set1_epi64x (B.inverse () >> 32);
+	const __m256i m = _mm256_set1_epi64x (B.modulus ());
+	const __m256i m_minus_1 = _mm256_set1_epi64x (B.modulus () - 1);
+	const __m256i mask32 = _mm256_set1_epi64x (0xffffffffULL);
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m256i a = _mm256_loadu_si256 ((const __m256i *) (arr + i));
+		const __m256i a_hi = _mm256_srli_epi64 (a, 32);
+
+		const __m256i ll = _mm256_mul_epu32 (a, inv_lo);
+		const __m256i lh = _mm256_mul_epu32 (a, inv_hi);
+		const __m256i hl = _mm256_mul_epu32 (a_hi, inv_lo);
+		const __m256i hh = _mm256_mul_epu32 (a_hi, inv_hi);
+
+		__m256i mid = _mm256_add_epi64 (_mm256_srli_epi64 (ll, 32), _mm256_and_si256 (lh, mask32));
+		mid = _mm256_add_epi64 (mid, _mm256_and_si256 (hl, mask32));
+
+		__m256i q = _mm256_add_epi64 (hh, _mm256_srli_epi64 (mid, 32));
+		q = _mm256_add_epi64 (q, _mm256_add_epi64 (_mm256_srli_epi64 (lh, 32), _mm256_srli_epi64 (hl, 32)));
+
+		// m < 2^32, so q * m = q_lo * m + (q_hi * m) << 32
+		const __m256i qm = _mm256_add_epi64 (_mm256_mul_epu32 (q, m),
+			_mm256_slli_epi64 (_mm256_mul_epu32 (_mm256_srli_epi64 (q, 32), m), 32));
+
+		// r < 2m < 2^33, so the signed comparison is safe
+		__m256i r = _mm256_sub_epi64 (a, qm);
+		r = _mm256_sub_epi64 (r, _mm256_and_si256 (_mm256_cmpgt_epi64 (r, m_minus_1), m));
+
+		_mm256_storeu_si256 ((__m256i *) (arr + i), r);
+	}
+
+	for (; i < n; ++i)
+		arr[i] = B.reduce (arr[i]);
+}
+
+// GCC 12 warns on the _mm512_undefined_epi32 () source of the AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+inline void barrettReduce__avx512 (const BarrettReduction &B, uint64 *arr, size_t n)
+{
+	const __m512i inv_lo = _mm512_set1_epi64 (B.inverse () & 0xffffffffULL);
+	const __m512i inv_hi = _mm512_set1_epi64 (B.inverse () >> 32);
+	const __m512i m = _mm512_set1_epi64 (B.modulus ());
+	const __m512i mask32 = _mm512_set1_epi64 (0xffffffffULL);
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m512i a = _mm512_loadu_si512 ((const void *) (arr + i));
+		const __m512i a_hi = _mm512_srli_epi64 (a, 32);
+
+		const __m512i ll = _mm512_mul_epu32 (a, inv_lo);
+		const __m512i lh = _mm512_mul_epu32 (a, inv_hi);
+		const __m512i hl = _mm512_mul_epu32 (a_hi, inv_lo);
+		const __m512i hh = _mm512_mul_epu32 (a_hi, inv_hi);
+
+		__m512i mid = _mm512_add_epi64 (_mm512_srli_epi64 (ll, 32), _mm512_and_si512 (lh, mask32));
+		mid = _mm512_add_epi64 (mid, _mm512_and_si512 (hl, mask32));
+
+		__m512i q = _mm512_add_epi64 (hh, _mm512_srli_epi64 (mid, 32));
+		q = _mm512_add_epi64 (q, _mm512_add_epi64 (_mm512_srli_epi64 (lh, 32), _mm512_srli_epi64 (hl, 32)));
+
+		const __m512i qm = _mm512_add_epi64 (_mm512_mul_epu32 (q, m),
+			_mm512_slli_epi64 (_mm512_mul_epu32 (_mm512_srli_epi64 (q, 32), m), 32));
+
+		__m512i r = _mm512_sub_epi64 (a, qm);
+		r = _mm512_mask_sub_epi64 (r, _mm512_cmpge_epu64_mask (r, m), r, m);
+
+		_mm512_storeu_si512 ((void *) (arr + i), r);
+	}
+
+	for (; i < n; ++i)
+		arr[i] = B.reduce (arr[i]);
+}
+#pragma GCC diagnostic pop
+
+} // namespace LELA
+
+#endif // __LELA_HAVE_BARRETT_SIMD
+
+#endif // __LELA_RING_MODULAR_REDUCTION_SIMD_H
@@ -0,0 +1,76 @@
+/* lela/ring/modular-reduction.h
+ * Copyright 2026 The LELA team
+ *
+ * Written by the LELA team
+ *
+ * Barrett reduction of 64-bit words modulo a fixed modulus
+ *
+ * ------------------------------------
+ *
+ * This file is part of LELA, licensed under the GNU General Public
+ * License version 3. See COPYING for more information.
+ */
+
+#ifndef __LELA_RING_MODULAR_REDUCTION_H
+#define __LELA_RING_MODULAR_REDUCTION_H
+
+#include <cstddef>
+
+#include "lela/integer.h"
+
+namespace LELA
+{
+
+/** Barrett reduction of 64-bit words modulo a modulus m < 2^32
+ *
+ * The constant floor ((2^64 - 1) / m) is computed once per modulus,
+ * so that reducing a word costs a multiplication instead of a
+ * division: the quotient estimate q = (a * inverse) >> 64 is at most
+ * one less than a / m, hence a - q * m lies in [0, 2m[ and one
+ * conditional subtraction gives the remainder.
+ *
+ * reduce (arr, n) reduces an array in place; AVX2 and AVX-512
+ * versions are in lela/ring/modular-reduction-simd.h, which is not
+ * included by lela/ring/modular.h.
+ *
+ * \ingroup ring
+ */
+class BarrettReduction
+{
+public:
+	BarrettReduction (uint64 modulus)
+		: _modulus (modulus), _inverse (~(uint64) 0 / modulus) {}
+
+	uint64 modulus () const { return _modulus; }
+
+	/// floor ((2^64 - 1) / m)
+	uint64 inverse () const { return _inverse; }
+
+	/// Return a mod m
+	inline uint64 reduce (uint64 a) const
+	{
+#ifdef __SIZEOF_INT128__
+		const uint64 q = (uint64) (((unsigned __int128) a * _inverse) >> 64);
+		const uint64 r = a - q * _modulus;
+
+		return r >= _modulus ? r - _modulus : r;
+#else
+		return a % _modulus;
+#endif
+	}
+
+	/// Reduce the n words of arr in place
+	inline void reduce (uint64 *arr, size_t n) const
+	{
+		for (size_t i = 0; i < n; ++i)
+			arr[i] = reduce (arr[i]);
+	}
+
+private:
+	uint64 _modulus;
+	uint64 _inverse;	// floor ((2^64 - 1) / _modulus)
+};
+
+} // namespace LELA
+
+#endif // __LELA_RING_MODULAR_REDUCTION_H
@@ -29,6 +29,7 @@
 #include "lela/randiter/nonzero.h"
 #include "lela/algorithms/strassen-winograd.h"
 #include "lela/ring/type-wrapper.h"
+#include "lela/ring/modular-reduction.h"
 
 #define FLOAT_MANTISSA 24
 #define DOUBLE_MANTISSA 53
@@ -128,6 +129,8 @@ struct ModularTraits<uint8>
 		{ return r = a % m; }
 	static Element &reduce (Element &r, int a, Element m) 
 		{ int t = a % (int) m; if (t < 0) t += m; return r = t; }
+	static Element &reduce (Element &r, uint64 a, const BarrettReduction &B)
+		{ return r = B.reduce (a); }
 	static Element &init_modulus (Element &elt, integer x)
 		{ elt = x.get_ui (); return elt; }
 	static std::ostream &write (std::ostream &os, const Element &x)
@@ -174,6 +177,8 @@ struct ModularTraits<uint16>
 		{ return r = a % m; }
 	static Element &reduce (Element &r, int a, Element m) 
 		{ int t = a % (int) m; if (t < 0) t += m; return r = t; }
+	static Element &reduce (Element &r, uint64 a, const BarrettReduction &B)
+		{ return r = B.reduce (a); }
 	static Element &init_modulus (Element &elt, integer x)
 		{ elt = x.get_ui (); return elt; }
 	static std::ostream &write (std::ostream &os, const Element &x)
@@ -218,6 +223,8 @@ struct ModularTraits<uint32>
 		{ return r = a % m; }
 	static Element &reduce (Element &r, int a, Element m) 
 		{ long long t = (long long) a % (long long) m; shift_up (t, m); return r = t; }
+	static Element &reduce (Element &r, uint64 a, const BarrettReduction &B)
+		{ return r = B.reduce (a); }
 	static Element &init_modulus (Element &elt, integer x)
 		{ elt = x.get_ui (); return elt; }
 	static std::ostream &write (std::ostream &os, const Element &x)